@@ -7,19 +7,31 @@
 
 
 #include <vector>
-#include <queue>
 #include <iostream>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <barrier>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <bit>
+#include <string>
+#include <filesystem>
 
 #include "AdjacencyList.hpp"
 #include "AdjacencyMatrix.hpp"
+#include "CsrGraph.hpp"
+#include "BitsetAdjacencyMatrix.hpp"
+#include "TraversalWorkspace.hpp"
+#include "MappedCsrGraph.hpp"
 
 
 /// This class runs BFS algorithm on provided graph.
+/// The graph is not copied, and all the buffers are kept between the 
+/// runs, so repeated runs on graphs of the same size allocate nothing.
 struct BfsRunner
 {
-	/// Representation of the graph.
-	AdjacencyList _g;
-
 	/// Start vertex, from which BFS is invoked.
 	int _source;
 
@@ -35,62 +47,250 @@ struct BfsRunner
 	std::vector<int> _labels;
 	std::vector<int> _parents;
 
+	/// Discovered vertices: the current frontier and the next one.
+	std::vector< int > _frontier, _next;
+
+	/// Bitmap of '_frontier', used by "run_hybrid()".
+	std::vector< bool > _inFrontier;
+
+	/// Used by "run_parallel()": "_owner[v]" is the smallest position in the
+	/// frontier of a vertex, which has edge to 'v' (accessed atomically), 
+	/// and the next frontiers, discovered by every thread.
+	std::vector< int > _owner;
+	std::vector< std::vector< int > > _localNext;
+
 	/// Runs BFS on provided graph 'g_', starting from the vertex 'source_'.
-	void run( const AdjacencyList& g_, int source_ ) {
-		_g = g_;  // Remember the arguments
+	void run( const AdjacencyList& g_, int source_ )
+		{ bfs( g_, source_ ); }
+	void run( const CsrGraph& g_, int source_ )
+		{ bfs( g_, source_ ); }
+	void run( const MappedCsrGraph& g_, int source_ )
+		{ bfs( g_, source_ ); }
+
+	void run_1q( const AdjacencyList& g_ , int source_ )
+		{ bfs_1q( g_, source_ ); }
+	void run_1q( const CsrGraph& g_ , int source_ )
+		{ bfs_1q( g_, source_ ); }
+	void run_1q( const MappedCsrGraph& g_ , int source_ )
+		{ bfs_1q( g_, source_ ); }
+
+	/// Thresholds of switching between top-down and bottom-up steps in
+	/// "run_hybrid()". Bottom-up is chosen when edges of the frontier
+	/// exceed "1/HYBRID_ALPHA" of edges of still unvisited vertices,
+	/// top-down is restored when the frontier has less than
+	/// "N/HYBRID_BETA" vertices.
+	static const int HYBRID_ALPHA = 14;
+	static const int HYBRID_BETA = 24;
+
+	/// Runs direction-optimizing BFS on graph 'g_', starting from 'source_'.
+	/// Small frontiers are expanded top-down (over outgoing edges), while
+	/// large ones are processed bottom-up: every unvisited vertex looks for
+	/// a parent in the frontier by its incoming edges, given by 'incoming_',
+	/// and stops at the first one found.
+	/// Computes same '_labels' as "run()", '_parents' may differ.
+	void run_hybrid( const CsrGraph& g_, const CsrGraph& incoming_, int source_ ) {
+		reset( g_.size(), source_ );
+		const int N = g_.size();  // Number of vertices
+		_inFrontier.assign( N, false );
+		std::vector< int >& frontier = _frontier;
+		std::vector< int >& next = _next;
+		frontier.assign( 1, _source );
+		_colors[ _source ] = GRAY;
+		_labels[ _source ] = 0;
+		long long unexploredEdges = g_.numEdges() - g_.degree( _source );
+		long long frontierEdges = g_.degree( _source );
+		bool bottomUp = false;
+		while ( ! frontier.empty() ) {
+			// Choose direction of the current step
+			if ( ! bottomUp && frontierEdges > unexploredEdges / HYBRID_ALPHA )
+				bottomUp = true;
+			else if ( bottomUp && (long long)frontier.size() < N / HYBRID_BETA )
+				bottomUp = false;
+			next.clear();
+			if ( bottomUp ) {
+				for ( int u : frontier )
+					_inFrontier[ u ] = true;
+				for ( int v = 0; v < N; ++v ) {
+					if ( _colors[ v ] != WHITE )
+						continue;
+					for ( int u : incoming_.neighbors( v ) )
+						if ( _inFrontier[ u ] ) {  // Parent of 'v' is found
+							next.push_back( v );
+							_parents[ v ] = u;
+							break;
+						}
+				}
+				for ( int u : frontier )
+					_inFrontier[ u ] = false;
+			}
+			else {
+				for ( int u : frontier )
+					for ( int v : g_.neighbors( u ) )
+						if ( _colors[ v ] == WHITE ) {
+							next.push_back( v );
+							_colors[ v ] = GRAY;
+							_parents[ v ] = u;
+						}
+			}
+			// Mark the processed and the newly discovered vertices
+			for ( int u : frontier )
+				_colors[ u ] = BLACK;
+			frontierEdges = 0;
+			for ( int v : next ) {
+				_colors[ v ] = GRAY;
+				_labels[ v ] = _labels[ _parents[ v ] ] + 1;
+				frontierEdges += g_.degree( v );
+			}
+			unexploredEdges -= frontierEdges;
+			frontier.swap( next );
+		}
+	}
+	/// Same as above, for undirected graph 'g_', where incoming edges
+	/// coincide with the outgoing ones.
+	void run_hybrid( const CsrGraph& g_, int source_ )
+		{ run_hybrid( g_, g_, source_ ); }
+
+	/// Runs level-synchronous BFS on graph 'g_' from 'source_', expanding
+	/// every frontier on 'numThreads' threads (all hardware threads, if 0).
+	/// Each thread handles a contiguous part of the frontier, and a vertex
+	/// is claimed by the frontier vertex with the smallest position, by an
+	/// atomic minimum. Thus '_labels', '_parents' and even the order of
+	/// discovery are identical to the ones of "run_1q()".
+	void run_parallel( const CsrGraph& g_, int source_, int numThreads = 0 ) {
+		static const int UNCLAIMED = std::numeric_limits< int >::max();
+		reset( g_.size(), source_ );
+		const int N = g_.size();  // Number of vertices
+		if ( numThreads <= 0 )
+			numThreads = std::max( 1, (int)std::thread::hardware_concurrency() );
+		_owner.assign( N, UNCLAIMED );
+		std::vector< int >& frontier = _frontier;
+		frontier.assign( 1, _source );
+		std::vector< std::vector< int > >& localNext = _localNext;
+		localNext.resize( numThreads );
+		for ( std::vector< int >& local : localNext )
+			local.clear();
+		_colors[ _source ] = GRAY;
+		_labels[ _source ] = 0;
+		int level = 0;
+		// Merges local next frontiers in the order of threads, when all
+		// of them finished the current level
+		auto onLevelEnd = [&]() noexcept {
+			frontier.clear();
+			for ( std::vector< int >& local : localNext ) {
+				frontier.insert( frontier.end(), local.cbegin(), local.cend() );
+				local.clear();
+			}
+			++level;
+		};
+		std::barrier claimed( numThreads );
+		std::barrier expanded( numThreads, onLevelEnd );
+		auto worker = [&]( int t ) {
+			while ( ! frontier.empty() ) {
+				const int F = (int)frontier.size();
+				const int first = (int)( (long long)F * t / numThreads );
+				const int last = (int)( (long long)F * (t+1) / numThreads );
+				// Claim all unvisited neighbors of our part of the frontier
+				for ( int i = first; i < last; ++i )
+					for ( int v : g_.neighbors( frontier[ i ] ) ) {
+						if ( _labels[ v ] != -1 )
+							continue;
+						std::atomic_ref< int > owner( _owner[ v ] );
+						int cur = owner.load( std::memory_order_relaxed );
+						while ( i < cur && ! owner.compare_exchange_weak(
+								cur, i, std::memory_order_relaxed ) )
+							;
+					}
+				claimed.arrive_and_wait();
+				// Discover the vertices, claimed by our part of the frontier
+				std::vector< int >& next = localNext[ t ];
+				for ( int i = first; i < last; ++i ) {
+					const int u = frontier[ i ];
+					for ( int v : g_.neighbors( u ) )
+						if ( std::atomic_ref< int >( _owner[ v ] ).load( std::memory_order_relaxed ) == i
+								&& _labels[ v ] == -1 ) {
+							next.push_back( v );
+							_colors[ v ] = GRAY;
+							_labels[ v ] = level + 1;
+							_parents[ v ] = u;
+						}
+					_colors[ u ] = BLACK;
+				}
+				expanded.arrive_and_wait();
+			}
+		};
+		std::vector< std::thread > threads;
+		for ( int t = 1; t < numThreads; ++t )
+			threads.emplace_back( worker, t );
+		worker( 0 );
+		for ( std::thread& th : threads )
+			th.join();
+	}
+
+protected:
+	/// Prepares for running BFS from 'source_' on a graph with 'N' vertices,
+	/// reusing memory of the previous run.
+	void reset( int N, int source_ ) {
 		_source = source_;
-		const int N = _g.size();  // Number of vertices
-		_colors = std::vector< Color >( N, WHITE );  // All vertices start from white
-		std::queue< int > q;  // Queue of discovered vertices
-		q.push( _source );
+		_colors.assign( N, WHITE );  // All vertices start from white
+		_labels.assign( N, -1 );
+		_parents.assign( N, -1 );
+	}
+
+	/// Runs BFS level by level on graph 'g', which can be any 
+	/// representation providing "size()" and "neighbors(u)".
+	template< typename Graph >
+	void bfs( const Graph& g, int source_ ) {
+		reset( g.size(), source_ );
+		std::vector< int >& q = _frontier;  // Discovered vertices
+		std::vector< int >& qNext = _next;  // The next discovered vertices
+		q.assign( 1, _source );
 		_colors[ _source ] = GRAY;
+		_labels[ _source ] = 0;
 		while ( ! q.empty() ) {
-			std::queue< int > qNext;  // The next discovered vertices
+			qNext.clear();
 			// Process all the discovered (but not yet processed) vertices of 'q'
-			while ( ! q.empty() ) {
-				int u = q.front();  // 'u' is discovered but not processed yet
-				q.pop();
+			for ( int u : q ) {  // 'u' is discovered but not processed yet
 				_colors[ u ] = BLACK;
-				for ( int v : _g._adj[ u ] )
+				for ( int v : g.neighbors( u ) )
 					if ( _colors[ v ] == WHITE ) {  // New vertex 'v' is discovered
-						qNext.push( v );
+						qNext.push_back( v );
 						_colors[ v ] = GRAY;
+						_labels[ v ] = _labels[ u ] + 1;
+						_parents[ v ] = u;
 					}
 			}
 			q.swap( qNext );  // Remember content of 'qNext' in 'q'
 		}
 	}
 
-	void run_1q( const AdjacencyList& g_ , int source_ ) {
-		_g = g_;
-		_source = source_;
-		const int N = _g.size();
-		_colors = std::vector< Color >( N, WHITE );
-		_labels = std::vector< int >( N, -1 );
-		std::queue< int > q;
-		q.push( _source );
+	/// Same as "bfs()", but keeps all the discovered vertices in one queue.
+	/// The queue is a vector, where vertices are never removed, but only
+	/// passed by its 'head'.
+	template< typename Graph >
+	void bfs_1q( const Graph& g, int source_ ) {
+		reset( g.size(), source_ );
+		std::vector< int >& q = _frontier;
+		q.assign( 1, _source );
 		_colors[ _source ] = GRAY;
 		_labels[ _source ] = 0;
-		while ( ! q.empty() ) {
-			int Size = q.size();
-			while ( Size -- ) {
-				int u = q.front();
-				q.pop();
-				for ( int v : _g._adj[ u ] ) {
-					if ( _colors[ v ] == WHITE ) {
-						q.push( v );
-						_colors[ v ] = GRAY;
-						_labels[ v ] = _labels[ u ] + 1;
-					}
+		for ( std::size_t head = 0; head < q.size(); ++head ) {
+			int u = q[ head ];
+			for ( int v : g.neighbors( u ) ) {
+				if ( _colors[ v ] == WHITE ) {
+					q.push_back( v );
+					_colors[ v ] = GRAY;
+					_labels[ v ] = _labels[ u ] + 1;
+					_parents[ v ] = u;
 				}
-				_colors[ u ] = BLACK;
 			}
+			_colors[ u ] = BLACK;
 		}
-
 	}
+
+public:
 	/// Prints colors of all vertices of provided graph, in 2 rows.
 	void printColors() const {
-		const int N = _g.size();
+		const int N = (int)_colors.size();
 		std::cout << " |";
 		for ( char ch = 'A'; ch < 'A' + N; ++ch )
 			std::cout << ' ' << ch;
@@ -113,7 +313,7 @@ struct BfsRunner
 	/// Label of 'v' shows at which iteration of BFS the vertex 'v' was
 	///   discovered.
 	void printLabels() const {
-		const int N = _g.size();
+		const int N = (int)_labels.size();
 		std::cout << " |";
 		for (char ch = 'A'; ch < 'A' + N; ++ch)
 			std::cout << ' ' << ch;
@@ -160,9 +360,14 @@ void printPath( const std::vector< int >& path )
 using std::cout;
 using std::endl;
 
+/// This class runs BFS algorithm on graphs, represented by adjacency
+/// matrix. The matrix is packed into bits, so all unvisited neighbors
+/// of a vertex are found one machine word at a time.
+/// A packed matrix is not copied, and all the buffers are kept between
+/// the runs, so repeated runs on it allocate nothing. Other representations
+/// should be packed once, and not before every run.
 struct BfsRunnerMatrix
 {
-	AdjacencyList _g;
 	int _source;
 	enum Color {
 		WHITE = 0,
@@ -172,26 +377,30 @@ struct BfsRunnerMatrix
 	std::vector< Color > _colors;
 	std::vector<int> _labels;
 
-	void run( const AdjacencyList& g_, int source_ ) {
-		_g = g_;
+	/// Set of all non-white vertices, in the layout of matrix rows.
+	BitsetAdjacencyMatrix::bits_type _visited;
+
+	/// Queue of discovered vertices, which are passed by its head.
+	std::vector< int > _queue;
+
+	void run( const BitsetAdjacencyMatrix& g_, int source_ ) {
 		_source = source_;
-		const int N = _g.size();
-		_colors = std::vector< Color >( N, WHITE );
-		_labels = std::vector< int >( N, -1 );
-		std::queue< int > q;
-		q.push( _source );
+		const int N = g_.size();
+		_colors.assign( N, WHITE );
+		_labels.assign( N, -1 );
+		_visited.assign( g_.wordsPerRow(), 0 );
+		std::vector< int >& q = _queue;
+		q.assign( 1, _source );
 		_colors[ _source ] = GRAY;
 		_labels[ _source ] = 0;
-		while ( ! q.empty() ) {
-			int u = q.front();
-			q.pop();
-			for ( int v = 0 ; v < N;++v) {
-				if ( _g.hasEdge(u,v) && _colors[ v ] == WHITE ) {
-					q.push( v );
-					_colors[ v ] = GRAY;
-					_labels[ v ] = _labels[ u ] + 1;
-				}
-			}
+		BitsetAdjacencyMatrix::addToSet( _visited, _source );
+		for ( std::size_t head = 0; head < q.size(); ++head ) {
+			int u = q[ head ];
+			g_.visitNewNeighbors( u, _visited, [&]( int v ) {
+				q.push_back( v );
+				_colors[ v ] = GRAY;
+				_labels[ v ] = _labels[ u ] + 1;
+			} );
 			_colors[ u ] = BLACK;
 
 		}
@@ -206,7 +415,7 @@ struct BfsRunnerMatrix
 
 	void printLabels() const {
 		std::cout << " |";
-		for (char ch = 'A'; ch < 'A' + _g.size(); ++ch)
+		for (char ch = 'A'; ch < 'A' + (int)_labels.size(); ++ch)
 			std::cout << ' ' << ch;
 		std::cout << " |\n |";
 		for (int lbl : _labels) {
@@ -220,6 +429,209 @@ struct BfsRunnerMatrix
 
 
 };
+/// This class answers many BFS queries on one large graph, each of which
+/// explores only a small region around its source. The state is kept in 
+/// a workspace with epoch stamps, so a query doesn't pay O(N) for 
+/// resetting it, and costs only as much as the region it explores.
+struct LocalBfsRunner
+{
+	/// State of the last query: distances are the labels.
+	TraversalWorkspace< int > _ws;
+
+	/// Runs BFS on graph 'g' from vertex 'source_', until 'target' is
+	/// discovered, or until all the vertices within 'maxDepth' edges from
+	/// 'source_' are discovered. 'g' can be any representation providing
+	/// "size()" and "neighbors(u)".
+	/// Returns distance to 'target', or -1 if it was not reached.
+	template< typename Graph >
+	int run( const Graph& g, int source_, int target = -1,
+			int maxDepth = std::numeric_limits< int >::max() ) {
+		_ws.begin( g.size() );
+		_ws.visit( source_, 0, -1 );
+		if ( source_ == target )
+			return 0;
+		// The visited vertices are in order of discovery, so serve as a queue
+		const std::vector< int >& q = _ws.visitedVertices();
+		for ( std::size_t head = 0; head < q.size(); ++head ) {
+			const int u = q[ head ];
+			const int label = _ws.distance( u );
+			if ( label == maxDepth )
+				break;  // All the next vertices are on the same depth
+			for ( int v : g.neighbors( u ) )
+				if ( ! _ws.isVisited( v ) ) {
+					_ws.visit( v, label + 1, u );
+					if ( v == target )
+						return label + 1;
+				}
+			_ws.setFinal( u );
+		}
+		return -1;
+	}
+
+	/// Returns label of vertex 'v' in the last query, or -1 if it was not
+	/// discovered.
+	int label( int v ) const
+		{ return _ws.isVisited( v ) ? _ws.distance( v ) : -1; }
+
+	/// Returns shortest path from the source of the last query to 'target'.
+	std::vector< int > calculatePathTo( int target ) const
+		{ return _ws.getPathTo( target ); }
+};
+
+
+/// This class runs BFS from many sources at once (MS-BFS). Every vertex
+/// keeps a bitmask of the sources, which have already reached it, and 
+/// a bitmask of the sources, for which it is in the current frontier.
+/// So one scan of neighbors of a vertex advances all the BFS-s, which are
+/// passing it, and the graph is read once per level for up to 64 sources,
+/// instead of once per source. More sources are processed in batches of 64.
+/// The gain is large on graphs of small diameter, where the frontiers of
+/// different sources overlap, and small on long graphs (like grids).
+struct MultiSourceBfsRunner
+{
+	typedef std::uint64_t mask_type;
+
+	/// Number of sources, processed at once.
+	static const int BATCH = 64;
+
+	/// The sources, from which BFS is run.
+	std::vector< int > _sources;
+
+	/// "_labels[i][v]" is the distance from "_sources[i]" to 'v', or -1 if
+	/// 'v' is not reachable from it.
+	std::vector< std::vector< int > > _labels;
+
+	/// Bit 'i' of "_seen[v]" is set, if source 'i' of the batch has
+	/// reached 'v'.
+	std::vector< mask_type > _seen;
+
+	/// Bit 'i' of "_visit[v]" (or "_visitNext[v]") is set, if 'v' is in
+	/// the current (or the next) frontier of source 'i' of the batch.
+	std::vector< mask_type > _visit, _visitNext;
+
+	/// Vertices, which are in the current (or the next) frontier of at
+	/// least one source.
+	std::vector< int > _frontier, _next;
+
+	/// Runs BFS on graph 'g' from all the 'sources'. 'g' can be any
+	/// representation providing "size()" and "neighbors(u)".
+	template< typename Graph >
+	void run( const Graph& g, const std::vector< int >& sources ) {
+		const int N = g.size();  // Number of vertices
+		_sources = sources;
+		_labels.resize( sources.size() );
+		for ( std::vector< int >& labels : _labels )
+			labels.assign( N, -1 );
+		_visit.assign( N, 0 );
+		_visitNext.assign( N, 0 );
+		for ( int first = 0; first < (int)sources.size(); first += BATCH )
+			runBatch( g, first, std::min( (int)sources.size(), first + BATCH ) );
+	}
+
+	/// Prints labels of all the vertices, one row per source.
+	void printLabels() const {
+		const int N = _labels.empty() ? 0 : (int)_labels.front().size();
+		std::cout << "   |";
+		for ( char ch = 'A'; ch < 'A' + N; ++ch )
+			std::cout << ' ' << ch;
+		std::cout << " |" << std::endl;
+		for ( int i = 0; i < (int)_sources.size(); ++i ) {
+			std::cout << ' ' << char('A' + _sources[ i ]) << " |";
+			for ( int label : _labels[ i ] )
+				if ( label == -1 )
+					std::cout << " -";
+				else
+					std::cout << ' ' << label;
+			std::cout << " |" << std::endl;
+		}
+	}
+
+protected:
+	/// Runs BFS from sources "_sources[first..last)" at once.
+	/// The frontier masks are empty after every batch, while '_seen' is
+	/// cleared in one O(N) pass before it.
+	template< typename Graph >
+	void runBatch( const Graph& g, int first, int last ) {
+		_seen.assign( g.size(), 0 );
+		_frontier.clear();
+		for ( int i = first; i < last; ++i ) {
+			const int s = _sources[ i ];
+			const mask_type bit = mask_type( 1 ) << ( i - first );
+			if ( _visit[ s ] == 0 )
+				_frontier.push_back( s );
+			_seen[ s ] |= bit;
+			_visit[ s ] |= bit;
+			_labels[ i ][ s ] = 0;
+		}
+		for ( int level = 1; ! _frontier.empty(); ++level ) {
+			_next.clear();
+			// Advance all the sources, which are passing 'u', at once
+			for ( int u : _frontier )
+				for ( int v : g.neighbors( u ) ) {
+					const mask_type fresh = _visit[ u ] & ~_seen[ v ];
+					if ( fresh != 0 ) {
+						if ( _visitNext[ v ] == 0 )
+							_next.push_back( v );
+						_visitNext[ v ] |= fresh;
+					}
+				}
+			for ( int u : _frontier )
+				_visit[ u ] = 0;
+			// Label the newly reached vertices
+			for ( int v : _next ) {
+				mask_type reached = _visitNext[ v ];
+				_seen[ v ] |= reached;
+				_visit[ v ] = reached;
+				_visitNext[ v ] = 0;
+				for ( ; reached != 0; reached &= reached - 1 )
+					_labels[ first + std::countr_zero( reached ) ][ v ] = level;
+			}
+			_frontier.swap( _next );
+		}
+	}
+};
+
+
+/// Generates undirected grid graph of size 'rows*cols', where vertex
+/// "r*cols+c" is connected with its 4 neighbors.
+CsrGraph generateGridGraph( int rows, int cols )
+{
+	CsrGraph g;
+	g._offsets.assign( 1, 0 );
+	for ( int r = 0; r < rows; ++r )
+		for ( int c = 0; c < cols; ++c ) {
+			const int u = r * cols + c;
+			if ( r > 0 )
+				g._targets.push_back( u - cols );
+			if ( c > 0 )
+				g._targets.push_back( u - 1 );
+			if ( c + 1 < cols )
+				g._targets.push_back( u + 1 );
+			if ( r + 1 < rows )
+				g._targets.push_back( u + cols );
+			g._offsets.push_back( (int)g._targets.size() );
+		}
+	return g;
+}
+
+
+/// Generates random directed graph with 'N' vertices, where every vertex
+/// has 'degree' outgoing edges to uniformly chosen vertices.
+CsrGraph generateRandomGraph( int N, int degree, unsigned seed )
+{
+	std::mt19937 rng( seed );
+	std::uniform_int_distribution< int > vertex( 0, N - 1 );
+	CsrGraph g;
+	g._offsets.assign( 1, 0 );
+	for ( int u = 0; u < N; ++u ) {
+		for ( int e = 0; e < degree; ++e )
+			g._targets.push_back( vertex( rng ) );
+		g._offsets.push_back( (int)g._targets.size() );
+	}
+	return g;
+}
+
+
 int main()
 {
 	/*
@@ -286,5 +698,249 @@ int main()
 		printPath( runner.calculatePathTo( 'Q'-'A' ) );
 	}
 
+	cout << "\t Running BFS from vertex 'A' on CSR graph ..." << endl;
+	{
+		CsrGraph csr( g );
+		BfsRunner runner;
+		runner.run_1q( csr, 0 );    // Corresponds to 'A'
+
+		cout << "Labels of vertices : " << endl;
+		runner.printLabels();
+
+		cout << "Path to 'I' : ";
+		printPath( runner.calculatePathTo( 'I'-'A' ) );
+	}
+
+	cout << "\t Running direction-optimizing BFS from vertex 'A' ..." << endl;
+	{
+		CsrGraph csr( g );
+		BfsRunner runner, sequential;
+		runner.run_hybrid( csr, 0 );    // Corresponds to 'A'
+		sequential.run_1q( csr, 0 );
+
+		cout << "Labels of vertices : " << endl;
+		runner.printLabels();
+
+		cout << "Same labels as 'run_1q()' : "
+				<< ( runner._labels == sequential._labels ) << endl;
+	}
+
+	cout << "\t Running BFS from vertex 'A' on bitset matrix ..." << endl;
+	{
+		BitsetAdjacencyMatrix m( g );
+		BfsRunnerMatrix runner;
+		runner.run( m, 0 );    // Corresponds to 'A'
+
+		cout << "Labels of vertices : " << endl;
+		runner.printLabels();
+	}
+
+	cout << "\t Converting random graph between list and bitset matrix ..." << endl;
+	{
+		using namespace std::chrono;
+		const int N = 16384;
+		const CsrGraph random = generateRandomGraph( N, 8, 11 );
+		AdjacencyList list;
+		list._adj.resize( N );
+		for ( int u = 0; u < N; ++u ) {
+			const std::span< const int > adj = random.neighbors( u );
+			list._adj[ u ].assign( adj.begin(), adj.end() );
+			list._adj[ u ].sort();
+			list._adj[ u ].unique();
+		}
+		for ( int numThreads : { 1, 0 } ) {
+			auto start = steady_clock::now();
+			const BitsetAdjacencyMatrix m( list, numThreads );
+			const auto packMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+			start = steady_clock::now();
+			const AdjacencyList back = m.toList( numThreads );
+			const auto unpackMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+			cout << "  " << ( numThreads == 0 ? "All" : "1" ) << " thread(s) : packing "
+					<< packMs << " ms, unpacking " << unpackMs << " ms, same list : "
+					<< ( back._adj == list._adj ) << endl;
+		}
+	}
+
+	cout << "\t Loading graph with a hub vertex ..." << endl;
+	{
+		using namespace std::chrono;
+		const int N = 10000;
+		std::vector< std::pair< int, int > > edges;
+		for ( int v = 1; v < N; ++v ) {
+			edges.emplace_back( 0, v );    // The hub
+			edges.emplace_back( v, 0 );
+			edges.emplace_back( 0, v );    // Duplicate
+		}
+		std::reverse( edges.begin(), edges.end() );
+		auto start = steady_clock::now();
+		AdjacencyList plain;
+		plain._adj.resize( N );
+		for ( const std::pair< int, int >& e : edges )
+			plain.addEdge( e.first, e.second );
+		const auto plainMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		start = steady_clock::now();
+		AdjacencyList indexed;
+		indexed._adj.resize( N );
+		indexed.setIndexed( true );
+		for ( const std::pair< int, int >& e : edges )
+			indexed.addEdge( e.first, e.second );
+		const auto indexedMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		start = steady_clock::now();
+		const AdjacencyList bulk = AdjacencyList::fromEdges( N, edges );
+		const auto bulkMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		cout << "  'addEdge()' : " << plainMs << " ms" << endl;
+		cout << "  'addEdge()' with index : " << indexedMs << " ms" << endl;
+		cout << "  'fromEdges()' : " << bulkMs << " ms" << endl;
+		plain._adj[ 0 ].sort();
+		indexed._adj[ 0 ].sort();
+		cout << "  Same graphs : " << ( plain._adj == indexed._adj && plain._adj == bulk._adj ) << endl;
+	}
+
+	cout << "\t Running parallel BFS from vertex 'A' ..." << endl;
+	{
+		CsrGraph csr( g );
+		BfsRunner runner, sequential;
+		runner.run_parallel( csr, 0, 4 );    // Corresponds to 'A'
+		sequential.run_1q( csr, 0 );
+
+		cout << "Labels of vertices : " << endl;
+		runner.printLabels();
+
+		cout << "Same labels and parents as 'run_1q()' : "
+				<< ( runner._labels == sequential._labels
+					&& runner._parents == sequential._parents ) << endl;
+	}
+
+	cout << "\t Running local BFS queries ..." << endl;
+	{
+		CsrGraph csr( g );
+		LocalBfsRunner local;
+		cout << "Distance from 'A' to 'I' : " << local.run( csr, 0, 'I'-'A' ) << endl;
+		cout << "Path to 'I' : ";
+		printPath( local.calculatePathTo( 'I'-'A' ) );
+		cout << "Distance from 'A' to 'Q' : " << local.run( csr, 0, 'Q'-'A' ) << endl;
+	}
+
+	cout << "\t Running multi-source BFS from 'A', 'E', 'M' and 'Q' ..." << endl;
+	{
+		CsrGraph csr( g );
+		MultiSourceBfsRunner runner;
+		const std::vector< int > sources = { 'A'-'A', 'E'-'A', 'M'-'A', 'Q'-'A' };
+		runner.run( csr, sources );
+		cout << "Labels of vertices : " << endl;
+		runner.printLabels();
+
+		bool same = true;
+		BfsRunner single;
+		for ( int i = 0; i < (int)sources.size(); ++i ) {
+			single.run_1q( csr, sources[ i ] );
+			same = same && single._labels == runner._labels[ i ];
+		}
+		cout << "Same labels as 'run_1q()' : " << same << endl;
+	}
+
+	cout << "\t Benchmarking multi-source BFS on random graph ..." << endl;
+	{
+		using namespace std::chrono;
+		const int N = 200000, SOURCES = 64;
+		const CsrGraph random = generateRandomGraph( N, 8, 7 );
+		std::mt19937 rng( 7 );
+		std::uniform_int_distribution< int > vertex( 0, N - 1 );
+		std::vector< int > sources( SOURCES );
+		for ( int& s : sources )
+			s = vertex( rng );
+		MultiSourceBfsRunner multi;
+		auto start = steady_clock::now();
+		multi.run( random, sources );
+		const auto multiMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		BfsRunner single;
+		bool same = true;
+		start = steady_clock::now();
+		for ( int i = 0; i < SOURCES; ++i ) {
+			single.run_1q( random, sources[ i ] );
+			same = same && single._labels == multi._labels[ i ];
+		}
+		const auto singleMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		cout << "  " << SOURCES << " sources at once : " << multiMs << " ms" << endl;
+		cout << "  " << SOURCES << " times 'run_1q()' : " << singleMs << " ms" << endl;
+		cout << "  Same labels : " << same << endl;
+	}
+
+	cout << "\t Benchmarking direction-optimizing BFS on random graph ..." << endl;
+	{
+		using namespace std::chrono;
+		const int N = 1000000, RUNS = 5;
+		const CsrGraph random = generateRandomGraph( N, 16, 5 );
+		const CsrGraph incoming = random.transposed();
+		BfsRunner topDown, hybrid;
+		auto start = steady_clock::now();
+		for ( int i = 0; i < RUNS; ++i )
+			topDown.run_1q( random, i );
+		const auto topDownMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		start = steady_clock::now();
+		for ( int i = 0; i < RUNS; ++i )
+			hybrid.run_hybrid( random, incoming, i );
+		const auto hybridMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		cout << "  " << RUNS << " times 'run_1q()' : " << topDownMs << " ms" << endl;
+		cout << "  " << RUNS << " times 'run_hybrid()' : " << hybridMs << " ms" << endl;
+		cout << "  Same labels : " << ( topDown._labels == hybrid._labels ) << endl;
+	}
+
+	cout << "\t Saving 1000x1000 grid to file, and mapping it back ..." << endl;
+	{
+		using namespace std::chrono;
+		const std::string path = ( std::filesystem::temp_directory_path() / "bfs_grid.csr" ).string();
+		auto start = steady_clock::now();
+		const CsrGraph grid = generateGridGraph( 1000, 1000 );
+		const auto buildMs = duration_cast< milliseconds >( steady_clock::now() - start ).count();
+		cout << "  Written : " << writeCsrGraphFile( path, grid ) << endl;
+		start = steady_clock::now();
+		const MappedCsrGraph mapped( path );
+		const auto mapUs = duration_cast< microseconds >( steady_clock::now() - start ).count();
+		cout << "  Mapped : " << mapped.isOpen() << ", checksum is valid : " << mapped.verify() << endl;
+		cout << "  Building : " << buildMs << " ms, mapping : " << mapUs << " us" << endl;
+		BfsRunner fromMemory, fromFile;
+		fromMemory.run_1q( grid, 0 );
+		fromFile.run_1q( mapped, 0 );
+		cout << "  Same labels : " << ( fromMemory._labels == fromFile._labels ) << endl;
+		std::filesystem::remove( path );
+	}
+
+	cout << "\t Benchmarking local BFS queries on 1000x1000 grid ..." << endl;
+	{
+		using namespace std::chrono;
+		const int SIDE = 1000, QUERIES = 10000, FULL_RUNS = 20;
+		const CsrGraph grid = generateGridGraph( SIDE, SIDE );
+		std::mt19937 rng( 42 );
+		std::uniform_int_distribution< int > coord( 0, SIDE - 9 ), shift( 0, 8 );
+		std::vector< std::pair< int, int > > queries( QUERIES );
+		for ( auto& q : queries ) {
+			const int r = coord( rng ), c = coord( rng );
+			q = { r * SIDE + c, ( r + shift( rng ) ) * SIDE + c + shift( rng ) };
+		}
+		LocalBfsRunner local;
+		long long localSum = 0;
+		auto start = steady_clock::now();
+		for ( const auto& q : queries )
+			localSum += local.run( grid, q.first, q.second );
+		const double localUs = duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count() / 1000.0 / QUERIES;
+		BfsRunner full;
+		long long fullSum = 0, localPartSum = 0;
+		start = steady_clock::now();
+		for ( int i = 0; i < FULL_RUNS; ++i ) {
+			full.run( grid, queries[ i ].first );
+			fullSum += full._labels[ queries[ i ].second ];
+		}
+		const double fullUs = duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count() / 1000.0 / FULL_RUNS;
+		for ( int i = 0; i < FULL_RUNS; ++i )  // Not timed
+			localPartSum += local.run( grid, queries[ i ].first, queries[ i ].second );
+		cout << "  Local query : " << localUs << " us (sum of distances " 
+				<< localSum << ")" << endl;
+		cout << "  Full BFS    : " << fullUs << " us" << endl;
+		cout << "  Same distances : " << ( fullSum == localPartSum ) << endl;
+	}
+
 	return 0;
 }
@@ -0,0 +1,230 @@
+
+#ifndef _BITSET_ADJACENCY_MATRIX_HPP
+#define _BITSET_ADJACENCY_MATRIX_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <bit>
+#include <thread>
+#include <algorithm>
+
+#include "AdjacencyMatrix.hpp"
+#include "AdjacencyList.hpp"
+
+
+/// Allocator, which places the elements at an address aligned by
+/// 'Alignment' bytes.
+template< typename T, std::size_t Alignment >
+struct AlignedAllocator
+{
+	typedef T value_type;
+
+	template< typename U >
+	struct rebind
+		{ typedef AlignedAllocator< U, Alignment > other; };
+
+	AlignedAllocator() = default;
+	template< typename U >
+	AlignedAllocator( const AlignedAllocator< U, Alignment >& )
+		{}
+
+	T* allocate( std::size_t n )
+		{ return static_cast< T* >( ::operator new(
+				n * sizeof( T ), std::align_val_t( Alignment ) ) ); }
+	void deallocate( T* p, std::size_t )
+		{ ::operator delete( p, std::align_val_t( Alignment ) ); }
+
+	template< typename U >
+	bool operator==( const AlignedAllocator< U, Alignment >& ) const
+		{ return true; }
+};
+
+
+/// This class represents adjacency matrix of an unweighted graph, where
+/// every row is packed into bits of machine words.
+/// Every row starts at a 64-byte boundary (a cache line), so operations
+/// on whole rows, like "row[u] & ~visited", are done one word at a time,
+/// and can be vectorized by the compiler.
+struct BitsetAdjacencyMatrix
+{
+	typedef std::uint64_t word_type;
+
+	/// Number of bits in one word.
+	static const int WORD_BITS = 64;
+
+	/// Alignment of every row, in bytes.
+	static const int ROW_ALIGNMENT = 64;
+
+	/// How a row of bits (or any other set of vertices) is represented.
+	typedef std::vector< word_type, AlignedAllocator< word_type, ROW_ALIGNMENT > >
+			bits_type;
+
+	/// Number of vertices.
+	int _n;
+
+	/// Number of words, which one row occupies (including the padding).
+	int _words_per_row;
+
+	/// The rows of the matrix, one after another.
+	/// There is an edge "(u,v)" only if bit 'v' of row 'u' is set.
+	bits_type _bits;
+
+public:
+	/// [Default] constructor
+	/// Creates a graph with 'N' vertices and no edges.
+	explicit BitsetAdjacencyMatrix( int N = 0 )
+		{ setSize( N ); }
+
+	/// Constructor
+	/// Packs provided adjacency matrix 'g', on 'numThreads' threads (0
+	/// means all the hardware threads).
+	explicit BitsetAdjacencyMatrix( const AdjacencyMatrix& g, int numThreads = 1 ) {
+		const int N = g.size();
+		setSize( N );
+		forEachRowRange( numThreads, [&]( int first, int last ) {
+			for ( int u = first; u < last; ++u )
+				for ( int v = 0; v < N; ++v )
+					if ( g._m[u][v] )
+						addEdge( u, v );
+		} );
+	}
+
+	/// Constructor
+	/// Packs provided adjacency list 'g' in O(N^2/64 + E), on 'numThreads'
+	/// threads (0 means all the hardware threads).
+	explicit BitsetAdjacencyMatrix( const AdjacencyList& g, int numThreads = 1 ) {
+		const int N = g.size();
+		setSize( N );
+		forEachRowRange( numThreads, [&]( int first, int last ) {
+			for ( int u = first; u < last; ++u )
+				for ( int v : g._adj[u] )
+					addEdge( u, v );
+		} );
+	}
+
+	/// Returns adjacency list of this graph, where neighbors of every vertex
+	/// are in increasing order. Works in O(N^2/64 + E), by iterating only
+	/// set bits of the rows, on 'numThreads' threads (0 means all the
+	/// hardware threads).
+	AdjacencyList toList( int numThreads = 1 ) const {
+		AdjacencyList result;
+		result._adj.resize( _n );
+		forEachRowRange( numThreads, [&]( int first, int last ) {
+			for ( int u = first; u < last; ++u ) {
+				const word_type* r = row( u );
+				for ( int w = 0; w < _words_per_row; ++w )
+					for ( word_type bits = r[w]; bits != 0; bits &= bits - 1 )
+						result._adj[u].push_back( w * WORD_BITS + std::countr_zero( bits ) );
+			}
+		} );
+		return result;
+	}
+
+	/// Returns number of words, needed for storing 'N' bits, rounded up
+	/// so that the words occupy whole number of 'ROW_ALIGNMENT'-s.
+	static int wordsFor( int N ) {
+		const int WORDS_PER_LINE = ROW_ALIGNMENT / (int)sizeof( word_type );
+		const int words = ( N + WORD_BITS - 1 ) / WORD_BITS;
+		return ( words + WORDS_PER_LINE - 1 ) / WORDS_PER_LINE * WORDS_PER_LINE;
+	}
+
+	/// Sets number of vertices in this graph.
+	/// Removes all existing edges by the way.
+	void setSize( int N )
+		{ _n = N;
+		  _words_per_row = wordsFor( N );
+		  _bits.assign( (std::size_t)N * _words_per_row, 0 ); }
+
+	/// Number of vertices in this graph.
+	int size() const
+		{ return _n; }
+
+	/// Number of words in one row.
+	int wordsPerRow() const
+		{ return _words_per_row; }
+
+	/// Returns the row of vertex 'u'.
+	const word_type* row( int u ) const
+		{ return _bits.data() + (std::size_t)u * _words_per_row; }
+	word_type* row( int u )
+		{ return _bits.data() + (std::size_t)u * _words_per_row; }
+
+	/// Check if edge "(u,v)" is present.
+	bool hasEdge( int u, int v ) const
+		{ return ( row(u)[ v / WORD_BITS ] >> ( v % WORD_BITS ) ) & 1; }
+	bool hasEdge( char u, char v ) const
+		{ return hasEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Adds edge "(u,v)" to this graph, in case if it was not present.
+	void addEdge( int u, int v )
+		{ row(u)[ v / WORD_BITS ] |= word_type( 1 ) << ( v % WORD_BITS ); }
+	void addEdge( char u, char v )
+		{ addEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Removes edge "(u,v)" from this graph, in case if it is present.
+	void removeEdge( int u, int v )
+		{ row(u)[ v / WORD_BITS ] &= ~( word_type( 1 ) << ( v % WORD_BITS ) ); }
+	void removeEdge( char u, char v )
+		{ removeEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Returns an empty set of vertices, having the same layout as one row.
+	bits_type emptySet() const
+		{ return bits_type( _words_per_row, 0 ); }
+
+	/// Adds vertex 'v' to the set 'vertices'.
+	static void addToSet( bits_type& vertices, int v )
+		{ vertices[ v / WORD_BITS ] |= word_type( 1 ) << ( v % WORD_BITS ); }
+
+	/// Calls 'f(v)' for every vertex 'v', for which edge "(u,v)" is
+	/// present, but 'v' is not in the set 'visited'. Such vertices are
+	/// added to 'visited' before the call.
+	template< typename Function >
+	void visitNewNeighbors( int u, bits_type& visited, Function f ) const {
+		const word_type* r = row( u );
+		for ( int w = 0; w < _words_per_row; ++w ) {
+			word_type fresh = r[w] & ~visited[w];
+			visited[w] |= fresh;
+			while ( fresh != 0 ) {
+				f( w * WORD_BITS + std::countr_zero( fresh ) );
+				fresh &= fresh - 1;  // Clear the lowest set bit
+			}
+		}
+	}
+
+	/// Returns the smallest vertex 'v', for which edge "(u,v)" is present
+	/// and 'v' is not in the set 'visited', starting the search from the
+	/// word 'w'. Returns -1, if there is no such vertex.
+	int firstNewNeighbor( int u, const bits_type& visited, int w = 0 ) const {
+		const word_type* r = row( u );
+		for ( ; w < _words_per_row; ++w ) {
+			const word_type fresh = r[w] & ~visited[w];
+			if ( fresh != 0 )
+				return w * WORD_BITS + std::countr_zero( fresh );
+		}
+		return -1;
+	}
+
+protected:
+	/// Splits the rows into 'numThreads' contiguous ranges, and calls
+	/// "f(first,last)" for every range on its own thread (0 means all the
+	/// hardware threads). As every row starts at a cache line, threads which
+	/// write to different rows never share a cache line.
+	template< typename Function >
+	void forEachRowRange( int numThreads, Function f ) const {
+		if ( numThreads <= 0 )
+			numThreads = std::max( 1, (int)std::thread::hardware_concurrency() );
+		numThreads = std::max( 1, std::min( numThreads, _n ) );
+		std::vector< std::thread > threads;
+		for ( int t = 1; t < numThreads; ++t )
+			threads.emplace_back( f, (int)( (long long)_n * t / numThreads ),
+					(int)( (long long)_n * ( t+1 ) / numThreads ) );
+		f( 0, _n / numThreads );
+		for ( std::thread& th : threads )
+			th.join();
+	}
+};
+
+
+#endif // _BITSET_ADJACENCY_MATRIX_HPP
@@ -20,6 +20,7 @@
 #include <list>
 #include <iostream>
 #include <algorithm>
+#include <thread>
 
 
 /// This class represents a simple adjacency matrix of a unweighted graph.
@@ -125,47 +126,80 @@ struct AdjacencyList
 
 /// Returns adjacency list of inversed graph of 'L'.
 /// In the inversed graph, every edge has opposite direction.
+/// Works in O(V+E): every edge "(u,v)" is appended to the list of 'v', so
+/// every list of the result is ordered by source vertex.
 AdjacencyList inversed( const AdjacencyList& L )
 {
 	AdjacencyList result;
 	const int N =L.size();
+	result._adj.resize(N);
 	for (int u = 0; u < N; u++) {
 		for (int v : L._adj[u]) {
-			result._adj[u].push_back(v);
+			result._adj[v].push_back(u);
 		}
 	}
 	return result;
 }
 
 
+/// Splits vertices "[0, N)" into 'numThreads' contiguous ranges, and
+/// calls "f(first,last)" for every range on its own thread (0 means all
+/// the hardware threads).
+template< typename Function >
+void forEachVertexRange( int N, int numThreads, Function f )
+{
+	if ( numThreads <= 0 )
+		numThreads = std::max( 1, (int)std::thread::hardware_concurrency() );
+	numThreads = std::max( 1, std::min( numThreads, N ) );
+	std::vector< std::thread > threads;
+	for ( int t = 1; t < numThreads; ++t )
+		threads.emplace_back( f, (int)( (long long)N * t / numThreads ),
+				(int)( (long long)N * ( t+1 ) / numThreads ) );
+	f( 0, N / numThreads );
+	for ( std::thread& th : threads )
+		th.join();
+}
+
+
 /// Converts representation of graph from adjacency list 'L' to
-/// adjacency matrix.
-AdjacencyMatrix convertToMatrix( const AdjacencyList& L )
+/// adjacency matrix, in O(N^2 + E), on 'numThreads' threads.
+/// Every thread fills its own range of rows, which are separate vectors.
+AdjacencyMatrix convertToMatrix( const AdjacencyList& L, int numThreads = 1 )
 {
 	const int N = L.size();
 	AdjacencyMatrix result;
-	for (int u = 0; u < N; u++) {
-		for (int v : L._adj[u]) {
-			result._m[u][v] = true;
+	result._m.resize( N );
+	forEachVertexRange( N, numThreads, [&]( int first, int last ) {
+		for (int u = first; u < last; u++) {
+			result._m[u].assign( N, false );
+			for (int v : L._adj[u]) {
+				result._m[u][v] = true;
+			}
 		}
-	}
+	} );
 	return result;
 }
 
 
 /// Converts representation of graph from adjacency matrix 'M' to
-/// adjacency list.
-AdjacencyList convertToList( const AdjacencyMatrix& M )
+/// adjacency list, in O(N^2), on 'numThreads' threads.
+/// Every thread fills its own range of lists.
+/// (Packed matrices are converted in O(N^2/64 + E), by 
+/// "BitsetAdjacencyMatrix::toList()".)
+AdjacencyList convertToList( const AdjacencyMatrix& M, int numThreads = 1 )
 {
 	const int N = M.size();
 	AdjacencyList result;
-	for (int u = 0; u < N; u++) {
-		for (int v = 0; v < N; v++) {
-			if (M._m[u][v]) {
-				result._adj[u].push_back(v);
+	result._adj.resize( N );
+	forEachVertexRange( N, numThreads, [&]( int first, int last ) {
+		for (int u = first; u < last; u++) {
+			for (int v = 0; v < N; v++) {
+				if (M._m[u][v]) {
+					result._adj[u].push_back(v);
+				}
 			}
 		}
-	}
+	} );
 	return result;
 }
 
@@ -258,6 +292,19 @@ int main( int argc, char* argv[] )
 
 		cout << "Has path [0, 1, 2, 4] : " << g2.existsPath( {0, 1, 2, 4} ) << endl;
 		cout << "Has path [0, 1, 3, 4] : " << g2.existsPath( {0, 1, 3, 4} ) << endl;
+
+		AdjacencyList g2_inversed = inversed( g2 );
+		cout << "Inversed graph has path [4, 2, 1, 0] : " 
+				<< g2_inversed.existsPath( {4, 2, 1, 0} ) << endl;
+		cout << "Inversed graph has path [0, 1, 2, 4] : " 
+				<< g2_inversed.existsPath( {0, 1, 2, 4} ) << endl;
+
+		AdjacencyMatrix g2_matrix = convertToMatrix( g2, 2 );
+		cout << "Matrix has path [0, 1, 2, 4] : " 
+				<< g2_matrix.existsPath( {0, 1, 2, 4} ) << endl;
+		cout << "Matrix has edge (3, 1) : " << g2_matrix.hasEdge( 3, 1 ) << endl;
+		AdjacencyList g2_list = convertToList( g2_matrix, 2 );
+		cout << "Converted back to list : " << ( g2_list._adj == g2._adj ) << endl;
 	}
 
 	return 0;
@@ -5,6 +5,10 @@
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <utility>
+#include <cstddef>
+
+#include "EdgeHashSet.hpp"
 
 
 /// This class represents given unweighted graph as adjacency list.
@@ -17,19 +21,31 @@ struct AdjacencyList
 	/// Adjacency list of the entire graph.
 	lists_type _adj;
 
+	/// Index of all the edges, used by "hasEdge()" when '_indexed' is set.
+	EdgeHashSet _index;
+
+	/// If the edges are indexed. Then they must be changed only by
+	/// "addEdge()" and "removeEdge()", which keep the index up to date.
+	bool _indexed = false;
+
 	/// Returns number of vertices in this graph.
 	int size() const
 		{ return (int)_adj.size(); }
 
+	/// Returns all vertices 'v', for which edge "(u,v)" is present.
+	const list_type& neighbors( int u ) const
+		{ return _adj[ u ]; }
+
 	/// Checks if the graph has edge "(u,v)".
 	bool hasEdge( int u, int v ) const
-		{ return std::count( _adj[u].cbegin(), _adj[u].cend(), v ) == 1; }
+		{ return _indexed ? _index.contains( u, v )
+				: std::count( _adj[u].cbegin(), _adj[u].cend(), v ) == 1; }
 	bool hasEdge( char u, char v ) const
 		{ return hasEdge( (int)(u-'A'), (int)(v-'A') ); }
 
 	/// Adds edge "(u,v)" to this graph, in case if it was not present.
 	void addEdge( int u, int v ) {
-		if ( ! hasEdge( u, v ) )
+		if ( _indexed ? _index.insert( u, v ) : ! hasEdge( u, v ) )
 			_adj[ u ].push_back( v );
 	}
 	void addEdge( char u, char v )
@@ -37,6 +53,8 @@ struct AdjacencyList
 
 	/// Removes edge "(u,v)" from this graph, in case if it is present.
 	void removeEdge( int u, int v ) {
+		if ( _indexed )
+			_index.erase( u, v );
 		_adj[ u ].remove( v );
 	}
 	void removeEdge( char u, char v )
@@ -53,6 +71,55 @@ struct AdjacencyList
 		}
 		return true;
 	}
+
+	/// Builds graph with 'N' vertices from the list of 'edges' "(u,v)",
+	/// skipping the duplicates, in O(N+E) time (instead of O(E*degree) of
+	/// "addEdge()"). The edges are radix sorted, by target and then stably
+	/// by source, so neighbors of every vertex are in increasing order.
+	static AdjacencyList fromEdges( int N, const std::vector< std::pair< int, int > >& edges ) {
+		typedef std::pair< int, int > edge_type;
+		const std::vector< edge_type > sorted = sortedBy(
+				sortedBy( edges, N, []( const edge_type& e ) { return e.second; } ),
+				N, []( const edge_type& e ) { return e.first; } );
+		AdjacencyList result;
+		result._adj.resize( N );
+		for ( std::size_t i = 0; i < sorted.size(); ++i )
+			if ( i == 0 || sorted[ i ] != sorted[ i-1 ] )
+				result._adj[ sorted[ i ].first ].push_back( sorted[ i ].second );
+		return result;
+	}
+
+	/// Turns indexing of the edges on or off. While it is on, "hasEdge()"
+	/// and "addEdge()" take O(1) expected time.
+	void setIndexed( bool indexed ) {
+		_indexed = indexed;
+		_index.clear();
+		if ( ! indexed )
+			return;
+		std::size_t count = 0;
+		for ( const list_type& adj : _adj )
+			count += adj.size();
+		_index.reserve( count );
+		for ( int u = 0; u < size(); ++u )
+			for ( int v : _adj[ u ] )
+				_index.insert( u, v );
+	}
+
+protected:
+	/// Returns 'edges' stably sorted by "key(e)", which is in "[0,N)", by
+	/// counting sort in O(N+E).
+	template< typename Edge, typename Key >
+	static std::vector< Edge > sortedBy( const std::vector< Edge >& edges, int N, Key key ) {
+		std::vector< std::size_t > start( N + 1, 0 );
+		for ( const Edge& e : edges )
+			++start[ key( e ) + 1 ];
+		for ( int k = 0; k < N; ++k )
+			start[ k+1 ] += start[ k ];
+		std::vector< Edge > result( edges.size() );
+		for ( const Edge& e : edges )
+			result[ start[ key( e ) ]++ ] = e;
+		return result;
+	}
 };
 
 
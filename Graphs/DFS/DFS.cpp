@@ -22,17 +22,249 @@
 #include <vector>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <span>
+#include <type_traits>
 
 #include "AdjacencyMatrix.hpp"
 #include "AdjacencyList.hpp"
+#include "CsrGraph.hpp"
+#include "BitsetAdjacencyMatrix.hpp"
+#include "TraversalWorkspace.hpp"
+
+
+/// This class finds strongly connected components of a directed graph, by
+/// Tarjan's algorithm, without recursion: every vertex on the DFS stack
+/// keeps a cursor to its next unvisited neighbor.
+/// Also builds the condensation, i.e. the acyclic graph of components, so
+/// reachability between vertices is answered by their components only.
+struct SCC_runner
+{
+	/// "_component[v]" is the index of the component of vertex 'v'.
+	/// Components are numbered in reverse topological order, so every
+	/// edge of the condensation goes from a greater index to a lesser one.
+	std::vector< int > _component;
+
+	/// Number of the components.
+	int _numComponents;
+
+	/// The condensation: vertex 'c' represents component 'c', and there
+	/// is edge "(c,d)" if some edge of the graph goes from 'c' to 'd'.
+	CsrGraph _condensation;
+
+	/// Reversed '_condensation'.
+	CsrGraph _condensationReversed;
+
+	/// Marks of components, visited while answering reachability queries.
+	std::vector< char > _visited;
+
+public:
+	/// Finds components of graph 'g', which can be any representation
+	/// providing "size()" and "neighbors(u)".
+	template< typename Graph >
+	void run( const Graph& g ) {
+		typedef decltype( g.neighbors( 0 ).begin() ) iterator_type;
+		// A vertex on the DFS stack, with the cursor over its neighbors
+		struct Frame {
+			int v;
+			iterator_type next, end;
+		};
+		const int N = g.size();  // Number of vertices
+		_component.assign( N, -1 );
+		_numComponents = 0;
+		std::vector< int > index( N, -1 );  // Order of discovery
+		std::vector< int > low( N );  // Least index, reachable from the subtree
+		std::vector< int > stack;  // Vertices of not yet completed components
+		std::vector< Frame > frames;  // The DFS stack
+		int counter = 0;
+		for ( int s = 0; s < N; ++s ) {
+			if ( index[ s ] != -1 )
+				continue;
+			auto enter = [&]( int v ) {
+				index[ v ] = low[ v ] = counter++;
+				stack.push_back( v );
+				frames.push_back( Frame{ v, g.neighbors( v ).begin(), g.neighbors( v ).end() } );
+			};
+			enter( s );
+			while ( ! frames.empty() ) {
+				Frame& f = frames.back();
+				if ( f.next != f.end ) {
+					const int w = *f.next++;
+					if ( index[ w ] == -1 )
+						enter( w );
+					else if ( _component[ w ] == -1 )  // 'w' is still on the stack
+						low[ f.v ] = std::min( low[ f.v ], index[ w ] );
+					continue;
+				}
+				// All neighbors of 'v' are processed
+				const int v = f.v;
+				frames.pop_back();
+				if ( ! frames.empty() )
+					low[ frames.back().v ] = std::min( low[ frames.back().v ], low[ v ] );
+				if ( low[ v ] == index[ v ] ) {  // 'v' is the root of a component
+					int w;
+					do {
+						w = stack.back();
+						stack.pop_back();
+						_component[ w ] = _numComponents;
+					} while ( w != v );
+					++_numComponents;
+				}
+			}
+		}
+		buildCondensation( g );
+	}
+
+	/// Checks if vertex 'v' is reachable from vertex 'u'.
+	/// Only the components between the ones of 'u' and 'v' are visited.
+	bool isReachable( int u, int v ) {
+		const int cu = _component[ u ], cv = _component[ v ];
+		if ( cu == cv )
+			return true;
+		if ( cu < cv )
+			return false;
+		markReachable( _condensation, cu, cv, false );
+		return _visited[ cv ];
+	}
+
+	/// Prints pairs of all such vertices (u,v) where only one is 
+	/// reachable from the other.
+	void reportAsymmetricalPairs() {
+		const int N = (int)_component.size();
+		std::vector< char > from( _numComponents );  // Reachable from 'u'
+		for ( int u = 0; u < N; ++u ) {
+			markReachable( _condensation, _component[ u ], 0, false );
+			from.swap( _visited );
+			markReachable( _condensationReversed, _component[ u ], _numComponents, true );
+			for ( int v = u + 1; v < N; ++v ) {
+				const int cv = _component[ v ];
+				if ( cv != _component[ u ] && ( from[ cv ] || _visited[ cv ] ) )
+					std::cout << "( " << (char)('A' + u) << " , " 
+							<< (char)('A' + v) << " )" << std::endl;
+			}
+		}
+	}
+
+protected:
+	/// Builds '_condensation' and '_condensationReversed' of graph 'g'.
+	template< typename Graph >
+	void buildCondensation( const Graph& g ) {
+		const int N = (int)_component.size();
+		// Group the vertices by their components
+		std::vector< int > first( _numComponents + 1, 0 );
+		for ( int v = 0; v < N; ++v )
+			++first[ _component[ v ] + 1 ];
+		for ( int c = 0; c < _numComponents; ++c )
+			first[ c+1 ] += first[ c ];
+		std::vector< int > members( N );
+		std::vector< int > pos( first.cbegin(), first.cend() - 1 );
+		for ( int v = 0; v < N; ++v )
+			members[ pos[ _component[ v ] ]++ ] = v;
+		// Collect distinct targets of every component
+		_condensation._offsets.assign( 1, 0 );
+		_condensation._targets.clear();
+		std::vector< int > lastSource( _numComponents, -1 );
+		for ( int c = 0; c < _numComponents; ++c ) {
+			lastSource[ c ] = c;  // No loops
+			for ( int i = first[ c ]; i < first[ c+1 ]; ++i )
+				for ( int w : g.neighbors( members[ i ] ) )
+					if ( lastSource[ _component[ w ] ] != c ) {
+						lastSource[ _component[ w ] ] = c;
+						_condensation._targets.push_back( _component[ w ] );
+					}
+			_condensation._offsets.push_back( (int)_condensation._targets.size() );
+		}
+		_condensationReversed = _condensation.transposed();
+	}
+
+	/// Marks in '_visited' all the components, reachable from 's' in
+	/// graph 'g', skipping ones which are less than 'bound', if 'g' is
+	/// the condensation, or greater than 'bound', if it is 'reversed'.
+	void markReachable( const CsrGraph& g, int s, int bound, bool reversed ) {
+		_visited.assign( _numComponents, false );
+		std::vector< int > stack( 1, s );
+		_visited[ s ] = true;
+		while ( ! stack.empty() ) {
+			const int c = stack.back();
+			stack.pop_back();
+			for ( int d : g.neighbors( c ) )
+				if ( ! _visited[ d ] && ( reversed ? d <= bound : d >= bound ) ) {
+					_visited[ d ] = true;
+					stack.push_back( d );
+				}
+		}
+	}
+};
+
+
+/// This class is an index, which answers if one vertex is reachable from
+/// another in O(1) time.
+/// Vertices are grouped into strongly connected components, and for every
+/// component the set of reachable components is kept as one row of a bit
+/// matrix. As components are numbered in reverse topological order, rows
+/// are filled in increasing order, each one by OR-ing whole words of the
+/// rows of its successors. Occupies "C*C/8" bytes, for 'C' components.
+struct ReachabilityIndex
+{
+	/// Components of the graph, and their condensation.
+	SCC_runner _scc;
+
+	/// There is edge "(c,d)" if component 'd' is reachable from 'c'.
+	BitsetAdjacencyMatrix _reach;
+
+public:
+	/// Builds the index for graph 'g', which can be any representation
+	/// providing "size()" and "neighbors(u)".
+	template< typename Graph >
+	void build( const Graph& g ) {
+		typedef BitsetAdjacencyMatrix::word_type word_type;
+		const int WORD_BITS = BitsetAdjacencyMatrix::WORD_BITS;
+		_scc.run( g );
+		const int C = _scc._numComponents;
+		_reach.setSize( C );
+		for ( int c = 0; c < C; ++c ) {
+			word_type* r = _reach.row( c );
+			_reach.addEdge( c, c );
+			for ( int d : _scc._condensation.neighbors( c ) ) {
+				// 'd' is less than 'c', and so are all components reachable from it
+				const word_type* rd = _reach.row( d );
+				for ( int w = 0, words = d / WORD_BITS + 1; w < words; ++w )
+					r[ w ] |= rd[ w ];
+			}
+		}
+	}
+
+	/// Checks if vertex 'v' is reachable from vertex 'u'.
+	bool isReachable( int u, int v ) const {
+		const int cu = _scc._component[ u ], cv = _scc._component[ v ];
+		return cu >= cv && _reach.hasEdge( cu, cv );
+	}
+
+	/// Returns number of components.
+	int numComponents() const
+		{ return _scc._numComponents; }
+
+	/// Returns number of bytes, occupied by the reachability bits.
+	std::size_t memoryBytes() const
+		{ return _reach._bits.size() * sizeof( BitsetAdjacencyMatrix::word_type ); }
+};
 
 
 /// This class is intended to run DFS algorithm over graphs, 
 /// represented by adjacency matrix.
+/// The matrix is packed into bits, so next unvisited neighbor of a 
+/// vertex is searched one machine word at a time.
+/// A packed matrix is not copied, and all the buffers are kept between
+/// the runs, so repeated runs on it allocate nothing. Other representations
+/// should be packed once, and not before every run.
 struct DFS_runner
 {
-	/// The graph, to run DFS on.
-	AdjacencyMatrix _g;
+	/// The graph, to run DFS on. It is not owned, and must outlive the run,
+	/// as well as following calls to "reportAsymmetricalPairs()".
+	const BitsetAdjacencyMatrix* _g = nullptr;
 
 	/// The vertex from which DFS was run.
 	int _source;
@@ -47,29 +279,58 @@ struct DFS_runner
 	/// Colors of all the vertices.
 	std::vector< Color > _colors;
 
+	/// Set of all non-white vertices, in the layout of matrix rows.
+	BitsetAdjacencyMatrix::bits_type _visited;
+
+	/// A vertex on the DFS stack.
+	struct Frame {
+		int u;
+		int w;  // Word of the row, from which the search continues
+	};
+
+	/// The DFS stack.
+	std::vector< Frame > _stack;
+
 protected:
 	/// Continues DFS algorithm from vertex 's'.
+	/// Has no recursion: every frame of the stack keeps the word of the 
+	/// row of its vertex, from which the search of new neighbors continues,
+	/// so every row is scanned only once.
 	void dfs( int s ) {
-		const int N = _g.size();  // Number of vertices
 		assert( _colors[ s ] == WHITE );
-		_colors[ s ] = GRAY;  // We enter the vertex 's'
-		for ( int t = 0; t < N; ++t )
-			if ( _g._m[s][t] && _colors[ t ] == WHITE )
-				dfs( t );
-		_colors[ s ] = BLACK;  // We leave the vertex 's'
+		std::vector< Frame >& stack = _stack;
+		auto enter = [&]( int u ) {
+			_colors[ u ] = GRAY;  // We enter the vertex 'u'
+			BitsetAdjacencyMatrix::addToSet( _visited, u );
+			stack.push_back( Frame{ u, 0 } );
+		};
+		enter( s );
+		while ( ! stack.empty() ) {
+			Frame& f = stack.back();
+			const int t = _g->firstNewNeighbor( f.u, _visited, f.w );
+			if ( t != -1 ) {
+				f.w = t / BitsetAdjacencyMatrix::WORD_BITS;
+				enter( t );
+			}
+			else {
+				_colors[ f.u ] = BLACK;  // We leave the vertex 'u'
+				stack.pop_back();
+			}
+		}
 	}
 
 public:
 	/// Runs DFS on graph 'g_', from provided vertex 'source_'.
-	void run( const AdjacencyMatrix& g_, int source_ ) {
-		_g = g_;  // Remember the arguments
+	void run( const BitsetAdjacencyMatrix& g_, int source_ ) {
+		_g = &g_;  // Remember the arguments
 		_source = source_;
-		const int N = _g.size();  // Number of vertices
-		_colors = std::vector< Color >( N, WHITE );  // All vertices start from white
+		const int N = _g->size();  // Number of vertices
+		_colors.assign( N, WHITE );  // All vertices start from white
+		_visited.assign( _g->wordsPerRow(), 0 );
 		dfs( source_ );
 	}
 	//
-	void run( const AdjacencyMatrix& g_, char source_ )
+	void run( const BitsetAdjacencyMatrix& g_, char source_ )
 		{ run( g_, source_-'A' ); }
 
 	/// Reports list of reachable and unreachable vertices, in 2 lines.
@@ -99,69 +360,56 @@ public:
 
 	/// Prints pairs of all such vertices (u,v) where only one is 
 	/// reachable from the other.
+	/// Uses strongly connected components, instead of running DFS from
+	/// every vertex and keeping N*N table of reachability.
 	void reportAsymmetricalPairs()  {
-
-		const int N = _g.size();
-
-		std::vector<std::vector<bool>> reachable(N ,std::vector<bool> (N , false));
-
-		for ( int u = 0; u < N ; ++ u){
-			run(_g,u);
-			for ( int v = 0; v < N ;++v){
-				if(_colors[v] != WHITE){
-					reachable[u][v] = true;
-				}
-			}
-		}
-
-		for ( int u = 0 ; u < N ; ++u){
-			for (int v = u+1; v < N ; ++v){
-				if ( reachable[u][v] != reachable[v][u]){
-					std::cout<<"( "<<(char)('A' + u) <<" , "<< (char)('A'+ v) <<" )"<<std::endl;
-				}
-			}
+		const int N = _g->size();
+		AdjacencyList l;
+		l._adj.resize( N );
+		for ( int u = 0; u < N; ++u ) {
+			BitsetAdjacencyMatrix::bits_type seen = _g->emptySet();
+			_g->visitNewNeighbors( u, seen, [&]( int v ) { l._adj[ u ].push_back( v ); } );
 		}
+		SCC_runner scc;
+		scc.run( CsrGraph( l ) );
+		scc.reportAsymmetricalPairs();
 	}
 
 
 	/// Runs DFS on graph 'g_', in an iterative manner.
-	void runIterative(const AdjacencyMatrix& g_, int source_) {
-		_g = g_;
-		_source = source_;
-		const int N = _g.size();
-		_colors = std::vector<Color>(N, WHITE);
-
-		std::vector<int> stack;
-		stack.push_back(source_);
-
-		while (!stack.empty()) {
-			int s = stack.back();
-
-			if (_colors[s] == WHITE) {
-				_colors[s] = GRAY;
-			}
-
-			bool pushed = false;
-			for (int t = 0; t < N; ++t) {
-				if (_g._m[s][t] && _colors[t] == WHITE) {
-					stack.push_back(t);
-					pushed = true;
-					break;
-				}
-			}
-
-			if (!pushed) {
-				_colors[s] = BLACK;
-				stack.pop_back();
-			}
-		}
+	/// Same as "run()", as "dfs()" is not recursive.
+	void runIterative(const BitsetAdjacencyMatrix& g_, int source_) {
+		run( g_, source_ );
 	}
 
 };
 
 
+/// Visitor of DFS, which does nothing. Derive from it, and hide the
+/// methods for the events which are of interest.
+/// Edge "(u,v)" is reported as:
+///    tree edge - if 'v' was discovered by it,
+///    back edge - if 'v' is an ancestor of 'u' (so there is a cycle),
+///    forward edge - if 'v' is a descendant of 'u', but not its child,
+///    cross edge - otherwise.
+struct DfsVisitor {
+    void discoverVertex(int /*u*/) {}
+    void finishVertex(int /*u*/) {}
+    void treeEdge(int /*u*/, int /*v*/) {}
+    void backEdge(int /*u*/, int /*v*/) {}
+    void forwardEdge(int /*u*/, int /*v*/) {}
+    void crossEdge(int /*u*/, int /*v*/) {}
+};
+
+/// This class runs DFS on graphs, represented by adjacency list or CSR.
+/// The graph is not copied, and all the buffers are kept between the
+/// runs, so repeated runs on graphs of the same size allocate nothing.
 struct DFS_runner_List {
-    AdjacencyList _g;
+    /// The last adjacency list, DFS was run on, or nullptr if the last run
+    /// was on another representation. It is not owned, and must outlive
+    /// following calls to "reportAsymmetricalPairs()".
+    const AdjacencyList* _g = nullptr;
+
     int _source;
 
     enum Color {
@@ -172,30 +420,156 @@ struct DFS_runner_List {
 
     std::vector<Color> _colors;
 
+    /// Times when every vertex was discovered and finished, or -1.
+    /// Both come from one counter, so the intervals of vertices
+    /// "[ discovery, finish ]" are nested the same way as the DFS trees.
+    std::vector<int> _discovery, _finish;
+
+    /// Vertices in order of their discovery, and in order of finishing.
+    std::vector<int> _preorder, _postorder;
+
+    /// The current time.
+    int _time;
+
+    /// A vertex on the DFS stack, with the cursor over its neighbors.
+    template <typename Iterator>
+    struct Frame {
+        int u;
+        Iterator next, end;
+    };
+
+    /// The DFS stacks, one for every supported kind of neighbor ranges:
+    /// lists of 'AdjacencyList', and spans of 'CsrGraph'.
+    std::vector<Frame<AdjacencyList::list_type::const_iterator>> _listStack;
+    std::vector<Frame<std::span<const int>::iterator>> _spanStack;
+
 protected:
-    void dfs(int s) {
+    /// Returns the DFS stack for neighbor ranges, iterated by 'Iterator'.
+    template <typename Iterator>
+    std::vector<Frame<Iterator>>& stackFor() {
+        static_assert(std::is_same_v<Iterator, AdjacencyList::list_type::const_iterator>
+                || std::is_same_v<Iterator, std::span<const int>::iterator>,
+                "DFS_runner_List supports only adjacency lists and spans of neighbors");
+        if constexpr (std::is_same_v<Iterator, AdjacencyList::list_type::const_iterator>)
+            return _listStack;
+        else
+            return _spanStack;
+    }
+
+    /// Prepares for running DFS on a graph with 'N' vertices.
+    void reset(int N) {
+        _colors.assign(N, WHITE);
+        _discovery.assign(N, -1);
+        _finish.assign(N, -1);
+        _preorder.clear();
+        _postorder.clear();
+        _time = 0;
+    }
+
+    /// Remembers graph 'g_' of the current run, if it is an adjacency list.
+    template <typename Graph>
+    void remember(const Graph& g_) {
+        if constexpr (std::is_same_v<Graph, AdjacencyList>)
+            _g = &g_;
+        else
+            _g = nullptr;
+    }
+
+    /// Continues DFS from vertex 's' on graph 'g', reporting the events to
+    /// 'visitor'. 'g' must provide "size()" and "neighbors(u)", which
+    /// returns either a list of 'AdjacencyList' or a "std::span<const int>"
+    /// (as 'CsrGraph' does), as there is a stack only for those.
+    /// Has no recursion: every frame of the stack keeps a cursor to the
+    /// next neighbor of its vertex, so every edge is examined once, and the
+    /// depth is limited only by the memory.
+    template <typename Graph, typename Visitor>
+    void dfs(const Graph& g, int s, Visitor& visitor) {
+        typedef decltype(g.neighbors(0).begin()) iterator_type;
         assert(_colors[s] == WHITE);
-        _colors[s] = GRAY;
-        for (int t : _g._adj[s]) {
-            if (_colors[t] == WHITE)
-                dfs(t);
+        std::vector<Frame<iterator_type>>& stack = stackFor<iterator_type>();
+        auto discover = [&](int u) {
+            _colors[u] = GRAY;
+            _discovery[u] = _time++;
+            _preorder.push_back(u);
+            visitor.discoverVertex(u);
+            stack.push_back(Frame<iterator_type>{ u, g.neighbors(u).begin(), g.neighbors(u).end() });
+        };
+        discover(s);
+        while (!stack.empty()) {
+            auto& f = stack.back();
+            if (f.next != f.end) {
+                const int u = f.u, v = *f.next++;
+                if (_colors[v] == WHITE) {
+                    visitor.treeEdge(u, v);
+                    discover(v);  // Invalidates 'f'
+                }
+                else if (_colors[v] == GRAY)
+                    visitor.backEdge(u, v);
+                else if (_discovery[u] < _discovery[v])
+                    visitor.forwardEdge(u, v);
+                else
+                    visitor.crossEdge(u, v);
+                continue;
+            }
+            const int u = f.u;
+            stack.pop_back();
+            _colors[u] = BLACK;
+            _finish[u] = _time++;
+            _postorder.push_back(u);
+            visitor.finishVertex(u);
         }
-        _colors[s] = BLACK;
+    }
+
+    template <typename Graph>
+    void dfs(const Graph& g, int s) {
+        DfsVisitor visitor;
+        dfs(g, s, visitor);
     }
 
 public:
     void run(const AdjacencyList& g_, int source_) {
-        _g = g_;
+        remember(g_);
         _source = source_;
-        int N = _g.size();
-        _colors = std::vector<Color>(N, WHITE);
-        dfs(source_);
+        reset(g_.size());
+        dfs(g_, source_);
     }
 
     void run(const AdjacencyList& g_, char source_) {
         run(g_, source_ - 'A');
     }
 
+    /// Runs DFS on a frozen CSR graph 'g_', from vertex 'source_'.
+    void run(const CsrGraph& g_, int source_) {
+        remember(g_);
+        _source = source_;
+        reset(g_.size());
+        dfs(g_, source_);
+    }
+
+    /// Runs DFS on graph 'g_' (an adjacency list, or a graph with spans of
+    /// neighbors, see "dfs()") from vertex 'source_', reporting the events
+    /// to 'visitor'.
+    template <typename Graph, typename Visitor>
+    void run(const Graph& g_, int source_, Visitor& visitor) {
+        remember(g_);
+        _source = source_;
+        reset(g_.size());
+        dfs(g_, source_, visitor);
+    }
+
+    /// Runs DFS on graph 'g_' (same kinds as above) from every vertex,
+    /// which was not reached yet, so all the vertices and edges are visited.
+    template <typename Graph, typename Visitor>
+    void runForest(const Graph& g_, Visitor& visitor) {
+        const int N = g_.size();
+        remember(g_);
+        _source = 0;
+        reset(N);
+        for (int s = 0; s < N; ++s)
+            if (_colors[s] == WHITE)
+                dfs(g_, s, visitor);
+    }
+
     void reportReachableAndUnreachable() const {
         std::cout << "reachable" << std::endl;
         for (int i = 0; i < _colors.size(); ++i) {
@@ -211,58 +585,156 @@ public:
         std::cout << std::endl;
     }
 
+    /// Prints pairs of all such vertices (u,v) where only one is
+    /// reachable from the other, by strongly connected components.
+    /// The last run must have been on an adjacency list.
     void reportAsymmetricalPairs() {
-        int N = _g.size();
-        std::vector<std::vector<bool>> reachable(N, std::vector<bool>(N, false));
-
-        for (int u = 0; u < N; ++u) {
-            run(_g, u);
-            for (int v = 0; v < N; ++v) {
-                if (_colors[v] != WHITE)
-                    reachable[u][v] = true;
-            }
-        }
+        assert(_g != nullptr && "The last run was not on an AdjacencyList");
+        reportAsymmetricalPairs(*_g);
+    }
 
-        for (int u = 0; u < N; ++u) {
-            for (int v = u + 1; v < N; ++v) {
-                if (reachable[u][v] != reachable[v][u])
-                    std::cout << "( " << (char)('A' + u) << " , " << (char)('A' + v) << " )" << std::endl;
-            }
-        }
+    /// Same as above, for graph 'g', which can be any representation
+    /// providing "size()" and "neighbors(u)".
+    template <typename Graph>
+    void reportAsymmetricalPairs(const Graph& g) {
+        SCC_runner scc;
+        scc.run(g);
+        scc.reportAsymmetricalPairs();
     }
 
+    /// Same as "run()", as DFS is never recursive.
     void runIterative(const AdjacencyList& g_, int source_) {
-        _g = g_;
-        _source = source_;
-        int N = _g.size();
-        _colors = std::vector<Color>(N, WHITE);
+        run(g_, source_);
+    }
 
-        std::vector<int> stack;
-        stack.push_back(source_);
+    void runIterative(const CsrGraph& g_, int source_) {
+        run(g_, source_);
+    }
+};
 
+/// This class answers many reachability queries on one large graph, by
+/// DFS which stops as soon as the target is found. The visited marks are
+/// kept in a workspace with epoch stamps, so a query doesn't pay O(N) for
+/// resetting them, and costs only as much as the region it explores.
+struct LocalDfsRunner {
+    /// State of the last query.
+    TraversalWorkspace<int> _ws;
+
+    /// Checks if vertex 'target' is reachable from vertex 'source' in
+    /// graph 'g', which can be any representation providing "size()"
+    /// and "neighbors(u)".
+    template <typename Graph>
+    bool isReachable(const Graph& g, int source, int target) {
+        _ws.begin(g.size());
+        std::vector<int>& stack = _ws._pending;
+        _ws.visit(source, 0, -1);
+        stack.push_back(source);
         while (!stack.empty()) {
-            int s = stack.back();
-
-            if (_colors[s] == WHITE)
-                _colors[s] = GRAY;
-
-            bool pushed = false;
-            for (int t : _g._adj[s]) {
-                if (_colors[t] == WHITE) {
-                    stack.push_back(t);
-                    pushed = true;
-                    break;
+            const int u = stack.back();
+            if (u == target)
+                return true;
+            stack.pop_back();
+            for (int v : g.neighbors(u))
+                if (!_ws.isVisited(v)) {
+                    _ws.visit(v, _ws.distance(u) + 1, u);
+                    stack.push_back(v);
                 }
-            }
-
-            if (!pushed) {
-                _colors[s] = BLACK;
-                stack.pop_back();
-            }
         }
+        return false;
+    }
+
+    /// Returns number of vertices, visited by the last query.
+    int numVisited() const {
+        return (int)_ws.visitedVertices().size();
+    }
+};
+
+
+/// Visitor of DFS, which prints classification of every edge.
+struct EdgePrinter : DfsVisitor {
+    void print(const char* kind, int u, int v) {
+        std::cout << "  (" << (char)('A' + u) << "," << (char)('A' + v) << ") : "
+                << kind << std::endl;
     }
+    void treeEdge(int u, int v) { print("tree", u, v); }
+    void backEdge(int u, int v) { print("back", u, v); }
+    void forwardEdge(int u, int v) { print("forward", u, v); }
+    void crossEdge(int u, int v) { print("cross", u, v); }
 };
 
+
+/// Generates a random graph with 'N' vertices and "N*degree" edges, most
+/// of which go from lesser vertex to greater one, so the graph has many
+/// small strongly connected components.
+AdjacencyList generateRandomGraph( int N, int degree, unsigned seed )
+{
+	std::mt19937 rng( seed );
+	std::uniform_int_distribution< int > vertex( 0, N - 1 );
+	AdjacencyList g;
+	g._adj.resize( N );
+	for ( int e = 0; e < N * degree; ++e ) {
+		int u = vertex( rng ), v = vertex( rng );
+		if ( u > v && e % 16 != 0 )
+			std::swap( u, v );
+		g._adj[ u ].push_back( v );  // Duplicates don't affect reachability
+	}
+	return g;
+}
+
+
+/// Builds reachability index for graph 'g', and compares its query
+/// throughput with queries answered by traversals.
+void benchmarkReachability( const AdjacencyList& g, int numQueries )
+{
+	using namespace std::chrono;
+	const CsrGraph csr( g );
+	const int N = csr.size();
+	std::mt19937 rng( 777 );
+	std::uniform_int_distribution< int > vertex( 0, N - 1 );
+	std::vector< std::pair< int, int > > queries( numQueries );
+	for ( auto& q : queries )
+		q = { vertex( rng ), vertex( rng ) };
+	auto report = [&]( const char* name, int count, auto answer ) {
+		int positive = 0;
+		const auto start = steady_clock::now();
+		for ( int i = 0; i < count; ++i )
+			positive += answer( queries[ i ].first, queries[ i ].second );
+		const double ns = (double)duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count();
+		const std::ios_base::fmtflags flags = std::cout.flags();
+		const std::streamsize precision = std::cout.precision( 1 );
+		std::cout << "  " << std::setw( 20 ) << std::left << name << std::right
+				<< std::setw( 12 ) << std::fixed 
+				<< ns / count << " ns/query   (" 
+				<< positive << " of " << count << " reachable)" << std::endl;
+		std::cout.flags( flags );
+		std::cout.precision( precision );
+	};
+
+	ReachabilityIndex index;
+	const auto start = steady_clock::now();
+	index.build( csr );
+	const auto finish = steady_clock::now();
+	std::cout << "  Vertices: " << N << ", edges: " << csr.numEdges() 
+			<< ", components: " << index.numComponents() << std::endl;
+	std::cout << "  Index built in " 
+			<< duration_cast< milliseconds >( finish - start ).count() << " ms, occupies " 
+			<< index.memoryBytes() / ( 1 << 20 ) << " MB" << std::endl;
+
+	report( "index", numQueries, [&]( int u, int v ) 
+			{ return index.isReachable( u, v ); } );
+	report( "condensation DFS", numQueries / 1000, [&]( int u, int v ) 
+			{ return index._scc.isReachable( u, v ); } );
+	LocalDfsRunner local;
+	report( "DFS until target", numQueries / 1000, [&]( int u, int v ) 
+			{ return local.isReachable( csr, u, v ); } );
+	DFS_runner_List runner;
+	report( "DFS from source", numQueries / 10000, [&]( int u, int v ) 
+			{ runner.run( csr, u );
+			  return runner._colors[ v ] != DFS_runner_List::WHITE; } );
+}
+
+
 using std::cout;
 using std::endl;
 
@@ -291,19 +763,20 @@ int main()
 	g.addEdge( 'I', 'J' );
 	g.addEdge( 'K', 'I' );
 
+	const BitsetAdjacencyMatrix packed( g );  // Must outlive the runs
 	DFS_runner runner;
 
 	cout << "\t Testing 'reportReachableAndUnreachable()' ..." << endl;
 	{
-		runner.run( g, 'A' );
+		runner.run( packed, 'A' );
 		cout << "After running from 'A': " << endl;
 		runner.reportReachableAndUnreachable();
 
-		runner.run( g, 'G' );
+		runner.run( packed, 'G' );
 		cout << "After running from 'G': " << endl;
 		runner.reportReachableAndUnreachable();
 
-		runner.run( g, 'K' );
+		runner.run( packed, 'K' );
 		cout << "After running from 'K': " << endl;
 		runner.reportReachableAndUnreachable();
 	}
@@ -313,5 +786,105 @@ int main()
 		runner.reportAsymmetricalPairs();
 	}
 
+	cout << "\t Testing 'SCC_runner' ..." << endl;
+	{
+		AdjacencyList l;
+		l._adj.resize( N );
+		for ( int u = 0; u < N; ++u )
+			for ( int v = 0; v < N; ++v )
+				if ( g.hasEdge( u, v ) )
+					l.addEdge( u, v );
+		SCC_runner scc;
+		scc.run( l );
+		cout << "Number of components : " << scc._numComponents << endl;
+		cout << "Components :";
+		for ( int v = 0; v < N; ++v )
+			cout << " " << (char)('A' + v) << ":" << scc._component[ v ];
+		cout << endl;
+		cout << "'H' is reachable from 'A' : " << scc.isReachable( 'A'-'A', 'H'-'A' ) << endl;
+		cout << "'A' is reachable from 'H' : " << scc.isReachable( 'H'-'A', 'A'-'A' ) << endl;
+		cout << "'C' is reachable from 'G' : " << scc.isReachable( 'G'-'A', 'C'-'A' ) << endl;
+	}
+
+	cout << "\t Testing 'ReachabilityIndex' ..." << endl;
+	{
+		AdjacencyList l;
+		l._adj.resize( N );
+		for ( int u = 0; u < N; ++u )
+			for ( int v = 0; v < N; ++v )
+				if ( g.hasEdge( u, v ) )
+					l.addEdge( u, v );
+		ReachabilityIndex index;
+		index.build( l );
+		cout << "Reachable from 'B' :";
+		for ( int v = 0; v < N; ++v )
+			if ( index.isReachable( 'B'-'A', v ) )
+				cout << " " << (char)('A' + v);
+		cout << endl;
+		cout << "Reachable from 'K' :";
+		for ( int v = 0; v < N; ++v )
+			if ( index.isReachable( 'K'-'A', v ) )
+				cout << " " << (char)('A' + v);
+		cout << endl;
+	}
+
+	cout << "\t Benchmarking reachability queries ..." << endl;
+	{
+		benchmarkReachability( generateRandomGraph( 20000, 3, 2024 ), 1000000 );
+	}
+
+	cout << "\t Testing DFS on CSR graph ..." << endl;
+	{
+		AdjacencyList l;
+		l._adj.resize( N );
+		for ( int u = 0; u < N; ++u )
+			for ( int v = 0; v < N; ++v )
+				if ( g.hasEdge( u, v ) )
+					l.addEdge( u, v );
+		CsrGraph csr( l );
+
+		DFS_runner_List list_runner;
+		list_runner.run( csr, 'G'-'A' );
+		cout << "After running from 'G': " << endl;
+		list_runner.reportReachableAndUnreachable();
+	}
+
+	cout << "\t Testing DFS with edge classification ..." << endl;
+	{
+		AdjacencyList l;
+		l._adj.resize( N );
+		for ( int u = 0; u < N; ++u )
+			for ( int v = 0; v < N; ++v )
+				if ( g.hasEdge( u, v ) )
+					l.addEdge( u, v );
+		l.addEdge( 'A', 'C' );  // A forward edge
+		l.addEdge( 'F', 'E' );  // A cross edge
+		DFS_runner_List list_runner;
+		EdgePrinter printer;
+		list_runner.runForest( l, printer );
+		cout << "Discovery/finish times :";
+		for ( int v = 0; v < N; ++v )
+			cout << " " << (char)('A' + v) << ":" << list_runner._discovery[ v ] 
+					<< "/" << list_runner._finish[ v ];
+		cout << endl;
+	}
+
+	cout << "\t Testing DFS on a deep chain ..." << endl;
+	{
+		const int DEPTH = 10000000;
+		CsrGraph chain;
+		chain._offsets.resize( DEPTH + 1 );
+		chain._targets.resize( DEPTH - 1 );
+		for ( int u = 0; u < DEPTH; ++u )
+			chain._offsets[ u ] = u;
+		chain._offsets[ DEPTH ] = DEPTH - 1;
+		for ( int u = 0; u + 1 < DEPTH; ++u )
+			chain._targets[ u ] = u + 1;
+		DFS_runner_List list_runner;
+		list_runner.run( chain, 0 );
+		cout << "Finish time of the source : " << list_runner._finish[ 0 ] << endl;
+		cout << "Last finished vertex : " << list_runner._postorder.back() << endl;
+	}
+
 	return 0;
 }
@@ -0,0 +1,85 @@
+
+#ifndef _DIAL_QUEUE_HPP
+#define _DIAL_QUEUE_HPP
+
+#include <vector>
+#include <cassert>
+
+
+/// This class represents Dial's bucket queue of vertices "0..N-1", keyed
+/// by non-negative integers.
+/// It is monotone: keys pushed must be not smaller than the last popped
+/// key, and not greater than it plus 'maxWeight'. That holds in Dijkstra's
+/// algorithm, when 'maxWeight' is the maximal weight of an edge. Then all
+/// the keys fit in "maxWeight+1" circular buckets, and every operation is
+/// O(1) amortized, plus O(maxWeight) for skipping the empty buckets.
+struct DialQueue
+{
+	typedef long long key_type;
+
+	/// "_buckets[k % B]" holds vertices with key 'k'.
+	/// When a key is decreased, the old entry is left in its bucket,
+	/// and is skipped when reached.
+	std::vector< std::vector< int > > _buckets;
+
+	/// "_keys[v]" is the key of vertex 'v', or -1 if 'v' is not in the queue.
+	std::vector< key_type > _keys;
+
+	/// The minimal key, which might be present in the queue.
+	key_type _cur;
+
+	/// Number of vertices in the queue.
+	int _count;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty queue for vertices "0..N-1", and keys which
+	/// exceed the minimal one by at most 'maxWeight'.
+	explicit DialQueue( int N = 0, int maxWeight = 1 )
+		: _buckets( maxWeight + 1 )
+		{ reset( N ); }
+
+	/// Makes this queue empty, and ready to hold vertices "0..N-1".
+	void reset( int N ) {
+		for ( std::vector< int >& b : _buckets )
+			b.clear();
+		_keys.assign( N, -1 );
+		_cur = 0;
+		_count = 0;
+	}
+
+	/// Checks if the queue is empty.
+	bool empty() const
+		{ return _count == 0; }
+
+	/// Inserts vertex 'v' with key 'k', or decreases its key to 'k'.
+	/// 'k' must not exceed the last popped key by more than 'maxWeight',
+	/// otherwise it would land in the bucket of a smaller key.
+	void pushOrDecrease( int v, key_type k ) {
+		assert( k >= _cur && k - _cur < (key_type)_buckets.size() );
+		if ( _keys[ v ] == -1 )
+			++_count;
+		_keys[ v ] = k;
+		_buckets[ k % (key_type)_buckets.size() ].push_back( v );
+	}
+
+	/// Removes and returns the vertex with minimal key.
+	int pop() {
+		while ( true ) {
+			std::vector< int >& b = _buckets[ _cur % (key_type)_buckets.size() ];
+			while ( ! b.empty() ) {
+				const int v = b.back();
+				b.pop_back();
+				if ( _keys[ v ] == _cur ) {  // Otherwise the entry is outdated
+					_keys[ v ] = -1;
+					--_count;
+					return v;
+				}
+			}
+			++_cur;
+		}
+	}
+};
+
+
+#endif // _DIAL_QUEUE_HPP
@@ -0,0 +1,131 @@
+
+#ifndef _EDGE_HASH_SET_HPP
+#define _EDGE_HASH_SET_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/// This class represents a set of edges "(u,v)" as an open-addressing
+/// hash table with linear probing, where every edge is packed into one
+/// 64-bit key. It serves as an index over adjacency lists, so checking if
+/// an edge is present takes O(1) expected time, instead of O(degree).
+/// The table is kept at most half full, and erased keys are removed by
+/// shifting the following keys back, so there are no tombstones.
+struct EdgeHashSet
+{
+	typedef std::uint64_t key_type;
+
+	/// Marks a free slot. It is never a key, as vertices are not negative.
+	static constexpr key_type EMPTY = ~key_type( 0 );
+
+	/// The slots of the table. Their number is 0 or a power of 2.
+	std::vector< key_type > _slots;
+
+	/// Number of edges in the set.
+	std::size_t _count = 0;
+
+public:
+	/// Number of edges in the set.
+	std::size_t size() const
+		{ return _count; }
+
+	/// Removes all the edges.
+	void clear()
+		{ _slots.clear();
+		  _count = 0; }
+
+	/// Prepares the table for 'n' edges, so adding them will not rehash.
+	void reserve( std::size_t n ) {
+		std::size_t capacity = 16;
+		while ( capacity < 2 * n )
+			capacity *= 2;
+		if ( capacity > _slots.size() )
+			rehash( capacity );
+	}
+
+	/// Checks if edge "(u,v)" is in the set.
+	bool contains( int u, int v ) const {
+		if ( _count == 0 )
+			return false;
+		const key_type k = keyOf( u, v );
+		return _slots[ slotOf( k ) ] == k;
+	}
+
+	/// Adds edge "(u,v)" to the set. Returns false if it was present.
+	bool insert( int u, int v ) {
+		if ( 2 * ( _count + 1 ) > _slots.size() )
+			rehash( _slots.empty() ? 16 : 2 * _slots.size() );
+		const key_type k = keyOf( u, v );
+		const std::size_t i = slotOf( k );
+		if ( _slots[ i ] == k )
+			return false;
+		_slots[ i ] = k;
+		++_count;
+		return true;
+	}
+
+	/// Removes edge "(u,v)" from the set. Returns false if it was absent.
+	bool erase( int u, int v ) {
+		if ( _count == 0 )
+			return false;
+		const key_type k = keyOf( u, v );
+		const std::size_t mask = _slots.size() - 1;
+		std::size_t i = slotOf( k );
+		if ( _slots[ i ] != k )
+			return false;
+		// Move back every following key of the cluster, which would not be
+		// found after slot 'i' becomes free
+		for ( std::size_t j = ( i + 1 ) & mask; _slots[ j ] != EMPTY; j = ( j + 1 ) & mask ) {
+			const std::size_t home = hashOf( _slots[ j ] ) & mask;
+			const bool stays = i < j ? ( i < home && home <= j )
+			                         : ( i < home || home <= j );
+			if ( ! stays ) {
+				_slots[ i ] = _slots[ j ];
+				i = j;
+			}
+		}
+		_slots[ i ] = EMPTY;
+		--_count;
+		return true;
+	}
+
+protected:
+	/// Packs edge "(u,v)" into a key.
+	static key_type keyOf( int u, int v )
+		{ return ( key_type( (std::uint32_t)u ) << 32 ) | (std::uint32_t)v; }
+
+	/// Mixes all the bits of key 'k' (finalizer of MurmurHash3), so
+	/// consecutive vertices don't form long clusters.
+	static std::size_t hashOf( key_type k ) {
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdULL;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ULL;
+		k ^= k >> 33;
+		return (std::size_t)k;
+	}
+
+	/// Returns the slot, which contains key 'k', or the free slot where
+	/// probing for it stops. The table must not be empty.
+	std::size_t slotOf( key_type k ) const {
+		const std::size_t mask = _slots.size() - 1;
+		std::size_t i = hashOf( k ) & mask;
+		while ( _slots[ i ] != EMPTY && _slots[ i ] != k )
+			i = ( i + 1 ) & mask;
+		return i;
+	}
+
+	/// Moves all the keys into a table of 'capacity' slots.
+	void rehash( std::size_t capacity ) {
+		std::vector< key_type > old( capacity, EMPTY );
+		old.swap( _slots );
+		for ( key_type k : old )
+			if ( k != EMPTY )
+				_slots[ slotOf( k ) ] = k;
+	}
+};
+
+
+#endif // _EDGE_HASH_SET_HPP
@@ -0,0 +1,345 @@
+
+#ifndef _MAPPED_CSR_GRAPH_HPP
+#define _MAPPED_CSR_GRAPH_HPP
+
+#include <vector>
+#include <span>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <utility>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/// Layout of a binary graph file, in compressed sparse row form:
+///    [ header | offsets | targets | weights ]
+/// where every section starts at a page boundary (of 'PAGE' bytes), so
+/// after mapping the file into memory, the arrays are used in place.
+/// All the numbers are in native byte order of the writing machine.
+struct CsrGraphFileHeader
+{
+	/// Identifies the format, and the byte order.
+	static const std::uint64_t MAGIC = 0x31485047525343ULL;  // "CSRGPH1"
+
+	/// Alignment of the sections.
+	static const std::uint64_t PAGE = 4096;
+
+	/// Types of edge weights.
+	enum WeightType : std::uint32_t {
+		UNWEIGHTED = 0,
+		INT32 = 1
+	};
+
+	std::uint64_t magic;
+	std::uint32_t version;
+	std::uint32_t weightType;
+
+	/// Number of vertices and edges.
+	std::uint64_t numVertices;
+	std::uint64_t numEdges;
+
+	/// Positions of the sections in the file, in bytes. "N+1" offsets are
+	/// 64-bit, 'E' targets and 'E' weights (if any) are 32-bit.
+	std::uint64_t offsetsAt;
+	std::uint64_t targetsAt;
+	std::uint64_t weightsAt;
+
+	/// Checksum of all the sections, see "checksumOf()".
+	std::uint64_t checksum;
+
+	/// Updates checksum 'h' by 'bytes' bytes at 'data' (which is padded up
+	/// to whole 64-bit words). Mixes one word at a time, like FNV-1a.
+	static std::uint64_t checksumOf( const void* data, std::size_t bytes,
+			std::uint64_t h = 0xcbf29ce484222325ULL ) {
+		const unsigned char* p = static_cast< const unsigned char* >( data );
+		for ( std::size_t i = 0; i < bytes; i += 8 ) {
+			std::uint64_t word = 0;
+			for ( std::size_t b = 0; b < 8 && i + b < bytes; ++b )
+				word |= std::uint64_t( p[ i + b ] ) << ( 8 * b );
+			h = ( h ^ word ) * 0x100000001b3ULL;
+		}
+		return h;
+	}
+};
+
+
+/// This class represents a frozen graph in compressed sparse row form,
+/// which is memory-mapped from a binary file (written by
+/// "writeCsrGraphFile()"). The arrays are used in place, so nothing is
+/// deserialized or copied: opening the file only validates them, in one
+/// pass, and opening a trusted file without validation costs O(1).
+/// Provides the same "size()", "neighbors(u)" and "weights(u)" as the
+/// in-memory CSR graphs, so the runners use it directly.
+struct MappedCsrGraph
+{
+	typedef std::int32_t weight_type;
+
+	/// The mapped file, or 'nullptr'.
+	void* _data = nullptr;
+
+	/// Size of the mapped file, in bytes.
+	std::size_t _bytes = 0;
+
+	/// The sections, pointing into the mapped file.
+	const CsrGraphFileHeader* _header = nullptr;
+	const std::uint64_t* _offsets = nullptr;
+	const std::int32_t* _targets = nullptr;
+	const weight_type* _weights = nullptr;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty graph, which is not mapped to any file.
+	MappedCsrGraph() = default;
+
+	/// Constructor
+	/// Maps and validates the file at 'path', see "open()".
+	explicit MappedCsrGraph( const std::string& path )
+		{ open( path ); }
+
+	MappedCsrGraph( const MappedCsrGraph& ) = delete;
+	MappedCsrGraph& operator=( const MappedCsrGraph& ) = delete;
+
+	MappedCsrGraph( MappedCsrGraph&& other ) noexcept
+		{ swap( other ); }
+	MappedCsrGraph& operator=( MappedCsrGraph&& other ) noexcept
+		{ close();
+		  swap( other );
+		  return *this; }
+
+	/// Destructor
+	/// Unmaps the file.
+	~MappedCsrGraph()
+		{ close(); }
+
+	/// Maps binary graph file at 'path' into memory, read-only, and
+	/// validates it in O(V+E): offsets must be non-decreasing, and all the
+	/// targets must be vertices, so the runners never access out of range.
+	/// Returns false if the file can't be mapped, or is not valid.
+	/// The checksum is not verified here (see "verify()").
+	bool open( const std::string& path ) {
+		if ( ! openUnchecked( path ) )
+			return false;
+		if ( ! hasValidRanges() ) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	/// Same as "open()", but validates only the header and sizes of the
+	/// sections, in O(1). Only for files, which are known to be written by
+	/// "writeCsrGraphFile()": otherwise the runners may access out of range.
+	bool openUnchecked( const std::string& path ) {
+		close();
+		const int fd = ::open( path.c_str(), O_RDONLY );
+		if ( fd < 0 )
+			return false;
+		struct stat st;
+		if ( ::fstat( fd, &st ) != 0 || st.st_size < (off_t)sizeof( CsrGraphFileHeader ) ) {
+			::close( fd );
+			return false;
+		}
+		_bytes = (std::size_t)st.st_size;
+		_data = ::mmap( nullptr, _bytes, PROT_READ, MAP_SHARED, fd, 0 );
+		::close( fd );  // The mapping stays valid
+		if ( _data == MAP_FAILED ) {
+			_data = nullptr;
+			_bytes = 0;
+			return false;
+		}
+		const unsigned char* base = static_cast< const unsigned char* >( _data );
+		_header = reinterpret_cast< const CsrGraphFileHeader* >( base );
+		if ( ! isValid() ) {
+			close();
+			return false;
+		}
+		_offsets = reinterpret_cast< const std::uint64_t* >( base + _header->offsetsAt );
+		_targets = reinterpret_cast< const std::int32_t* >( base + _header->targetsAt );
+		if ( _header->weightType == CsrGraphFileHeader::INT32 )
+			_weights = reinterpret_cast< const weight_type* >( base + _header->weightsAt );
+		return true;
+	}
+
+	/// Unmaps the file, if any.
+	void close() {
+		if ( _data != nullptr )
+			::munmap( _data, _bytes );
+		_data = nullptr;
+		_bytes = 0;
+		_header = nullptr;
+		_offsets = nullptr;
+		_targets = nullptr;
+		_weights = nullptr;
+	}
+
+	/// Checks if a file is mapped.
+	bool isOpen() const
+		{ return _data != nullptr; }
+
+	/// Recalculates the checksum of all the sections, and compares it with
+	/// the one from the header, so detects damaged files. Reads the entire
+	/// file.
+	bool verify() const {
+		if ( ! isOpen() )
+			return false;
+		const std::uint64_t N = _header->numVertices, E = _header->numEdges;
+		std::uint64_t h = CsrGraphFileHeader::checksumOf( _offsets, ( N + 1 ) * sizeof( std::uint64_t ) );
+		h = CsrGraphFileHeader::checksumOf( _targets, E * sizeof( std::int32_t ), h );
+		if ( _weights != nullptr )
+			h = CsrGraphFileHeader::checksumOf( _weights, E * sizeof( weight_type ), h );
+		return h == _header->checksum;
+	}
+
+	/// Returns number of vertices in this graph.
+	int size() const
+		{ return _header == nullptr ? 0 : (int)_header->numVertices; }
+
+	/// Returns number of edges in this graph.
+	long long numEdges() const
+		{ return _header == nullptr ? 0 : (long long)_header->numEdges; }
+
+	/// Checks if the edges have weights.
+	bool hasWeights() const
+		{ return _weights != nullptr; }
+
+	/// Returns number of edges, which start at vertex 'u'.
+	int degree( int u ) const
+		{ return (int)( _offsets[ u+1 ] - _offsets[ u ] ); }
+
+	/// Returns all vertices 'v', for which edge "(u,v)" is present.
+	std::span< const int > neighbors( int u ) const
+		{ return std::span< const int >(
+				_targets + _offsets[ u ],
+				_targets + _offsets[ u+1 ] ); }
+
+	/// Returns weights of all the edges, which start at vertex 'u', in the
+	/// same order as "neighbors(u)". The graph must have weights.
+	std::span< const weight_type > weights( int u ) const
+		{ assert( hasWeights() );
+		  return std::span< const weight_type >(
+				_weights + _offsets[ u ],
+				_weights + _offsets[ u+1 ] ); }
+
+protected:
+	/// Checks the header, and that all the sections are aligned and lie
+	/// within the mapped file.
+	bool isValid() const {
+		const CsrGraphFileHeader& h = *_header;
+		if ( h.magic != CsrGraphFileHeader::MAGIC || h.version != 1
+				|| h.weightType > CsrGraphFileHeader::INT32
+				|| h.numVertices >= ( std::uint64_t( 1 ) << 31 )
+				|| h.numEdges >= ( std::uint64_t( 1 ) << 40 ) )
+			return false;
+		auto fits = [&]( std::uint64_t at, std::uint64_t bytes ) {
+			return at % CsrGraphFileHeader::PAGE == 0 && at <= _bytes && bytes <= _bytes - at;
+		};
+		if ( ! fits( h.offsetsAt, ( h.numVertices + 1 ) * sizeof( std::uint64_t ) )
+				|| ! fits( h.targetsAt, h.numEdges * sizeof( std::int32_t ) ) )
+			return false;
+		if ( h.weightType == CsrGraphFileHeader::INT32
+				&& ! fits( h.weightsAt, h.numEdges * sizeof( weight_type ) ) )
+			return false;
+		// Only the bounding offsets are checked here, the rest are checked
+		// by "hasValidRanges()"
+		const std::uint64_t* offsets = reinterpret_cast< const std::uint64_t* >(
+				static_cast< const unsigned char* >( _data ) + h.offsetsAt );
+		if ( offsets[ 0 ] != 0 || offsets[ h.numVertices ] != h.numEdges )
+			return false;
+		return true;
+	}
+
+	/// Checks that the offsets are non-decreasing, and that all the targets
+	/// are in "[0,N)". Reads both sections once.
+	bool hasValidRanges() const {
+		const std::uint64_t N = _header->numVertices, E = _header->numEdges;
+		for ( std::uint64_t u = 0; u < N; ++u )
+			if ( _offsets[ u ] > _offsets[ u+1 ] )
+				return false;
+		bool inRange = true;
+		for ( std::uint64_t e = 0; e < E; ++e )
+			inRange &= (std::uint64_t)(std::uint32_t)_targets[ e ] < N;
+		return inRange;
+	}
+
+	/// Exchanges the mappings of this and 'other'.
+	void swap( MappedCsrGraph& other ) {
+		std::swap( _data, other._data );
+		std::swap( _bytes, other._bytes );
+		std::swap( _header, other._header );
+		std::swap( _offsets, other._offsets );
+		std::swap( _targets, other._targets );
+		std::swap( _weights, other._weights );
+	}
+};
+
+
+/// Writes graph 'g' to binary file at 'path', which can be mapped by
+/// 'MappedCsrGraph'. 'g' can be any representation providing "size()"
+/// and "neighbors(u)"; if it also provides "weights(u)" (and
+/// "hasWeights()" is true, if provided), the weights are written too.
+/// Returns false if the file can't be written.
+template< typename Graph >
+bool writeCsrGraphFile( const std::string& path, const Graph& g )
+{
+	typedef CsrGraphFileHeader Header;
+	bool weighted = requires { g.weights( 0 ); };
+	if constexpr ( requires { g.hasWeights(); } )
+		weighted = weighted && g.hasWeights();
+	const int N = g.size();  // Number of vertices
+	// The sections
+	std::vector< std::uint64_t > offsets( N + 1, 0 );
+	std::vector< std::int32_t > targets;
+	std::vector< MappedCsrGraph::weight_type > weights;
+	for ( int u = 0; u < N; ++u ) {
+		for ( int v : g.neighbors( u ) )
+			targets.push_back( v );
+		if constexpr ( requires { g.weights( u ); } )
+			if ( weighted )
+				for ( auto w : g.weights( u ) )
+					weights.push_back( (MappedCsrGraph::weight_type)w );
+		offsets[ u+1 ] = targets.size();
+	}
+	auto aligned = []( std::uint64_t at )
+		{ return ( at + Header::PAGE - 1 ) / Header::PAGE * Header::PAGE; };
+	Header h = {};
+	h.magic = Header::MAGIC;
+	h.version = 1;
+	h.weightType = weighted ? Header::INT32 : Header::UNWEIGHTED;
+	h.numVertices = N;
+	h.numEdges = targets.size();
+	h.offsetsAt = aligned( sizeof( Header ) );
+	h.targetsAt = aligned( h.offsetsAt + offsets.size() * sizeof( std::uint64_t ) );
+	h.weightsAt = weighted ? aligned( h.targetsAt + targets.size() * sizeof( std::int32_t ) ) : 0;
+	h.checksum = Header::checksumOf( offsets.data(), offsets.size() * sizeof( std::uint64_t ) );
+	h.checksum = Header::checksumOf( targets.data(), targets.size() * sizeof( std::int32_t ), h.checksum );
+	if ( weighted )
+		h.checksum = Header::checksumOf( weights.data(),
+				weights.size() * sizeof( MappedCsrGraph::weight_type ), h.checksum );
+	// Write the sections, padding them by zeros
+	std::FILE* file = std::fopen( path.c_str(), "wb" );
+	if ( file == nullptr )
+		return false;
+	std::uint64_t at = 0;
+	auto put = [&]( std::uint64_t start, const void* data, std::size_t bytes ) {
+		static const char zeros[ Header::PAGE ] = {};
+		const std::size_t padding = start - at;  // Less than a page
+		at = start + bytes;
+		return std::fwrite( zeros, 1, padding, file ) == padding
+				&& std::fwrite( data, 1, bytes, file ) == bytes;
+	};
+	bool ok = put( 0, &h, sizeof( h ) )
+			&& put( h.offsetsAt, offsets.data(), offsets.size() * sizeof( std::uint64_t ) )
+			&& put( h.targetsAt, targets.data(), targets.size() * sizeof( std::int32_t ) );
+	if ( weighted )
+		ok = ok && put( h.weightsAt, weights.data(), weights.size() * sizeof( MappedCsrGraph::weight_type ) );
+	return std::fclose( file ) == 0 && ok;
+}
+
+
+#endif // _MAPPED_CSR_GRAPH_HPP
@@ -0,0 +1,124 @@
+
+#ifndef _RADIX_HEAP_HPP
+#define _RADIX_HEAP_HPP
+
+#include <vector>
+#include <utility>
+#include <bit>
+
+
+/// This class represents a monotone radix heap of vertices "0..N-1",
+/// keyed by non-negative integers.
+/// Keys pushed must be not smaller than the last popped key. Bucket 'i'
+/// holds keys, which first differ from the last popped key at bit "i-1",
+/// so every key moves only towards lower buckets, at most 64 times.
+/// Unlike "DialQueue", the range of the keys is not limited.
+struct RadixHeap
+{
+	typedef unsigned long long key_type;
+
+	/// Number of buckets: one for every bit, plus one for keys equal
+	/// to '_last'.
+	static const int BUCKETS = 65;
+
+	/// How one entry of a bucket is represented: the key and the vertex.
+	/// When a key is decreased, the old entry is left in its bucket,
+	/// and is dropped when reached.
+	typedef std::pair< key_type, int > entry_type;
+
+	/// The buckets.
+	std::vector< entry_type > _buckets[ BUCKETS ];
+
+	/// "_keys[v]" is the key of vertex 'v', while it is in the heap.
+	std::vector< key_type > _keys;
+
+	/// "_in[v] == true" only if 'v' is in the heap.
+	std::vector< bool > _in;
+
+	/// The last popped key.
+	key_type _last;
+
+	/// Number of vertices in the heap.
+	int _count;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty heap for vertices "0..N-1".
+	explicit RadixHeap( int N = 0 )
+		{ reset( N ); }
+
+	/// Makes this heap empty, and ready to hold vertices "0..N-1".
+	void reset( int N ) {
+		for ( std::vector< entry_type >& b : _buckets )
+			b.clear();
+		_keys.assign( N, 0 );
+		_in.assign( N, false );
+		_last = 0;
+		_count = 0;
+	}
+
+	/// Checks if the heap is empty.
+	bool empty() const
+		{ return _count == 0; }
+
+	/// Inserts vertex 'v' with key 'k', or decreases its key to 'k'.
+	void pushOrDecrease( int v, key_type k ) {
+		if ( ! _in[ v ] ) {
+			_in[ v ] = true;
+			++_count;
+		}
+		_keys[ v ] = k;
+		_buckets[ bucketOf( k ) ].push_back( entry_type( k, v ) );
+	}
+
+	/// Removes and returns the vertex with minimal key.
+	int pop() {
+		while ( true ) {
+			while ( _buckets[ 0 ].empty() )
+				redistribute();
+			const entry_type e = _buckets[ 0 ].back();
+			_buckets[ 0 ].pop_back();
+			if ( isActual( e ) ) {
+				_in[ e.second ] = false;
+				--_count;
+				return e.second;
+			}
+		}
+	}
+
+protected:
+	/// Returns index of the bucket, to which key 'k' belongs.
+	int bucketOf( key_type k ) const
+		{ return k == _last ? 0 : 64 - std::countl_zero( k ^ _last ); }
+
+	/// Checks if entry 'e' was not outdated by a later decrease of key.
+	bool isActual( const entry_type& e ) const
+		{ return _in[ e.second ] && _keys[ e.second ] == e.first; }
+
+	/// Sets '_last' to the minimal key of the first non-empty bucket,
+	/// and moves all its entries to lower buckets. Outdated entries are
+	/// dropped, so bucket 0 might still remain empty.
+	void redistribute() {
+		int i = 1;
+		while ( _buckets[ i ].empty() )
+			++i;
+		bool found = false;
+		key_type m = 0;  // Minimal actual key of bucket 'i'
+		for ( const entry_type& e : _buckets[ i ] )
+			if ( isActual( e ) && ( ! found || e.first < m ) ) {
+				m = e.first;
+				found = true;
+			}
+		std::vector< entry_type > moved;
+		moved.swap( _buckets[ i ] );
+		if ( ! found )
+			return;
+		_last = m;
+		for ( const entry_type& e : moved )
+			if ( isActual( e ) )
+				_buckets[ bucketOf( e.first ) ].push_back( e );
+	}
+};
+
+
+#endif // _RADIX_HEAP_HPP
@@ -0,0 +1,125 @@
+
+#ifndef _TRAVERSAL_WORKSPACE_HPP
+#define _TRAVERSAL_WORKSPACE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+
+/// This class keeps the per-vertex state of a graph traversal (BFS, DFS,
+/// Dijkstra's SP), and is reused by consecutive traversals of one graph.
+/// Every vertex has a stamp, and its state is valid only if the stamp
+/// equals to the current epoch. So a new traversal starts by incrementing
+/// the epoch in O(1) time, instead of refilling arrays of size N, and
+/// costs only as much as the region, which it explores.
+template< typename Distance >
+struct TraversalWorkspace
+{
+	typedef std::uint32_t stamp_type;
+
+	/// A vertex 'v' is visited by the current traversal (not white), only
+	/// if "_stamps[v] == _epoch".
+	std::vector< stamp_type > _stamps;
+
+	/// The current epoch. Stamps are never equal to it at the beginning of
+	/// a traversal.
+	stamp_type _epoch;
+
+	/// Distances of the visited vertices.
+	std::vector< Distance > _dist;
+
+	/// Parents of the visited vertices, -1 for the source.
+	std::vector< int > _parents;
+
+	/// Flags of the visited vertices, which are final (black).
+	std::vector< char > _final;
+
+	/// All the visited vertices, in order of their visiting.
+	std::vector< int > _visited;
+
+	/// Vertices, waiting to be processed (a stack or a queue).
+	std::vector< int > _pending;
+
+public:
+	/// [Default] constructor
+	/// Creates workspace for graphs with 'N' vertices.
+	explicit TraversalWorkspace( int N = 0 )
+		: _epoch( 0 )
+		{ begin( N ); }
+
+	/// Starts a new traversal on a graph with 'N' vertices: all the
+	/// vertices become not visited.
+	/// Takes O(1) time, unless 'N' differs from the previous traversal, or
+	/// the epoch counter wraps around.
+	void begin( int N ) {
+		if ( (int)_stamps.size() != N ) {
+			_stamps.assign( N, 0 );
+			_dist.resize( N );
+			_parents.resize( N );
+			_final.resize( N );
+			_epoch = 0;
+		}
+		if ( ++_epoch == 0 ) {  // The counter wrapped around
+			std::fill( _stamps.begin(), _stamps.end(), 0 );
+			_epoch = 1;
+		}
+		_visited.clear();
+		_pending.clear();
+	}
+
+	/// Number of vertices.
+	int size() const
+		{ return (int)_stamps.size(); }
+
+	/// Checks if vertex 'v' is visited by the current traversal.
+	bool isVisited( int v ) const
+		{ return _stamps[ v ] == _epoch; }
+
+	/// Checks if vertex 'v' is visited and final.
+	bool isFinal( int v ) const
+		{ return isVisited( v ) && _final[ v ]; }
+
+	/// Returns distance of visited vertex 'v'.
+	Distance distance( int v ) const
+		{ return _dist[ v ]; }
+
+	/// Returns parent of visited vertex 'v'.
+	int parent( int v ) const
+		{ return _parents[ v ]; }
+
+	/// Sets distance and parent of vertex 'v', and marks it as visited
+	/// (but not final), if it was not.
+	void visit( int v, Distance d, int parent ) {
+		if ( ! isVisited( v ) ) {
+			_stamps[ v ] = _epoch;
+			_final[ v ] = false;
+			_visited.push_back( v );
+		}
+		_dist[ v ] = d;
+		_parents[ v ] = parent;
+	}
+
+	/// Marks visited vertex 'v' as final.
+	void setFinal( int v )
+		{ _final[ v ] = true; }
+
+	/// Returns all the vertices, visited by the current traversal.
+	const std::vector< int >& visitedVertices() const
+		{ return _visited; }
+
+	/// Returns path from the source to visited vertex 't', by the parents.
+	/// If 't' is not visited, returns empty path.
+	std::vector< int > getPathTo( int t ) const {
+		std::vector< int > path;
+		if ( ! isVisited( t ) )
+			return path;
+		for ( int v = t; v != -1; v = _parents[ v ] )
+			path.push_back( v );
+		std::reverse( path.begin(), path.end() );
+		return path;
+	}
+};
+
+
+#endif // _TRAVERSAL_WORKSPACE_HPP
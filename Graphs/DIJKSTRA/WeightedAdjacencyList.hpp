@@ -0,0 +1,176 @@
+
+#ifndef _WEIGHTED_ADJACENCY_LIST_HPP
+#define _WEIGHTED_ADJACENCY_LIST_HPP
+
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <cstddef>
+#include <ranges>
+
+#include "EdgeHashSet.hpp"
+
+
+// How weight of an edge is represented
+typedef int adj_list_weight_type;
+
+
+/// This class represents given weighted graph as adjacency list.
+struct WeightedAdjacencyList
+{
+	/// How 1 edge is represented
+	typedef std::pair< int, adj_list_weight_type > edge_type;
+
+	/// How all adjacent edges are represented
+	typedef std::list< edge_type > list_type;
+
+	/// How the graph is represented
+	typedef std::vector< list_type > lists_type;
+
+	/// Adjacency list of the entire graph.
+	lists_type _adj;
+
+	/// Index of all the edges, used by "hasEdge()" when '_indexed' is set.
+	EdgeHashSet _index;
+
+	/// If the edges are indexed. Then they must be changed only by
+	/// "addEdge()" and "removeEdge()", which keep the index up to date.
+	bool _indexed = false;
+
+public:
+	/// [Default] constructor.
+	explicit WeightedAdjacencyList( int N = 0 )
+		{ setSize( N ); }
+
+	/// Updates number of vertices in the graph.
+	/// Clears existing edges, by the way.
+	void setSize( int N )
+		{ _adj.clear();
+		  _adj.resize( N );
+		  _index.clear(); }
+
+	/// Returns number of vertices in this graph.
+	int size() const
+		{ return (int)_adj.size(); }
+
+	/// Checks if the graph has edge "(u,v)".
+	bool hasEdge( int u, int v ) const
+		{ return _indexed ? _index.contains( u, v ) : std::count_if( _adj[u].cbegin(), _adj[u].cend(), 
+				[v]( const edge_type& e ) 
+					{ return e.first == v; } 
+				) == 1; }
+	bool hasEdge( char u, char v ) const
+		{ return hasEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Returns all vertices 'v', for which edge "(u,v)" is present, and
+	/// weights of those edges in the same order. Both are views over the
+	/// list of 'u', so the edges are read in place.
+	auto neighbors( int u ) const
+		{ return std::views::keys( _adj[ u ] ); }
+	auto weights( int u ) const
+		{ return std::views::values( _adj[ u ] ); }
+
+	/// Adds edge "(u,v)", having weight 'w' to this graph, 
+	/// in case if it was not present.
+	void addEdge( int u, int v, adj_list_weight_type w ) {
+		if ( _indexed ? _index.insert( u, v ) : ! hasEdge(u, v) )
+			_adj[ u ].push_back( edge_type(v, w) );
+	}
+	void addEdge( char u, char v, adj_list_weight_type w )
+		{ addEdge( (int)(u-'A'), (int)(v-'A'), w ); }
+
+	/// Adds undirected edge (u,v) to this graph, with specified 'w'.
+	void addUndirectedEdge( int u, int v, adj_list_weight_type w )
+		{ addEdge( u, v, w );
+		  addEdge( v, u, w ); }
+	void addUndirectedEdge( char u, char v, adj_list_weight_type w )
+		{ addUndirectedEdge( (int)(u-'A'), (int)(v-'A'), w ); }
+
+	/// Removes edge "(u,v)" from this graph, in case if it is present.
+	void removeEdge( int u, int v ) {
+		if ( _indexed )
+			_index.erase( u, v );
+		_adj[ u ].remove_if(
+				[v]( const edge_type& e ) 
+					{ return e.first == v; } 
+				);
+	}
+	void removeEdge( char u, char v )
+		{ removeEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Removes undirected edge (u,v) from this graph.
+	void removeUndirectedEdge( int u, int v )
+		{ removeEdge( u, v );
+		  removeEdge( v, u ); }
+	void removeUndirectedEdge( char u, char v )
+		{ removeUndirectedEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Prints this adjacency list to the console
+	void print() const
+	{
+		using namespace std;
+		const int N = size();
+		for ( int i = 0; i < N; ++i ) {
+			cout << "  " << char('A'+i) << ": [";
+			for ( const auto& e : _adj[i] )
+				cout << " (" << char('A'+e.first) << "," << e.second << ")";
+			cout << " ]" << endl;
+		}
+	}
+
+	/// Builds graph with 'N' vertices from the list of 'edges' "(u,(v,w))",
+	/// in O(N+E) time (instead of O(E*degree) of "addEdge()"). Of several
+	/// edges "(u,v)" only the first one is kept, like by "addEdge()".
+	/// The edges are radix sorted, by target and then stably by source, so
+	/// neighbors of every vertex are in increasing order.
+	static WeightedAdjacencyList fromEdges( int N, 
+			const std::vector< std::pair< int, edge_type > >& edges ) {
+		typedef std::pair< int, edge_type > full_edge_type;
+		const std::vector< full_edge_type > sorted = sortedBy(
+				sortedBy( edges, N, []( const full_edge_type& e ) { return e.second.first; } ),
+				N, []( const full_edge_type& e ) { return e.first; } );
+		WeightedAdjacencyList result( N );
+		for ( std::size_t i = 0; i < sorted.size(); ++i )
+			if ( i == 0 || sorted[ i ].first != sorted[ i-1 ].first
+					|| sorted[ i ].second.first != sorted[ i-1 ].second.first )
+				result._adj[ sorted[ i ].first ].push_back( sorted[ i ].second );
+		return result;
+	}
+
+	/// Turns indexing of the edges on or off. While it is on, "hasEdge()"
+	/// and "addEdge()" take O(1) expected time.
+	void setIndexed( bool indexed ) {
+		_indexed = indexed;
+		_index.clear();
+		if ( ! indexed )
+			return;
+		std::size_t count = 0;
+		for ( const list_type& adj : _adj )
+			count += adj.size();
+		_index.reserve( count );
+		for ( int u = 0; u < size(); ++u )
+			for ( const edge_type& e : _adj[ u ] )
+				_index.insert( u, e.first );
+	}
+
+protected:
+	/// Returns 'edges' stably sorted by "key(e)", which is in "[0,N)", by
+	/// counting sort in O(N+E).
+	template< typename Edge, typename Key >
+	static std::vector< Edge > sortedBy( const std::vector< Edge >& edges, int N, Key key ) {
+		std::vector< std::size_t > start( N + 1, 0 );
+		for ( const Edge& e : edges )
+			++start[ key( e ) + 1 ];
+		for ( int k = 0; k < N; ++k )
+			start[ k+1 ] += start[ k ];
+		std::vector< Edge > result( edges.size() );
+		for ( const Edge& e : edges )
+			result[ start[ key( e ) ]++ ] = e;
+		return result;
+	}
+};
+
+
+#endif // _WEIGHTED_ADJACENCY_LIST_HPP
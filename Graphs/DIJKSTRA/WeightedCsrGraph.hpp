@@ -0,0 +1,119 @@
+
+#ifndef _WEIGHTED_CSR_GRAPH_HPP
+#define _WEIGHTED_CSR_GRAPH_HPP
+
+#include <vector>
+#include <span>
+#include <iostream>
+
+#include "WeightedAdjacencyList.hpp"
+
+
+/// This class represents a frozen (not modifiable) weighted graph in
+/// compressed sparse row form.
+/// Edges, which start at vertex 'u', occupy the index range
+/// "[ _offsets[u], _offsets[u+1] )" of both '_targets' and '_weights'.
+struct WeightedCsrGraph
+{
+	typedef std::vector< int > offsets_type;
+	typedef std::vector< int > targets_type;
+	typedef std::vector< adj_list_weight_type > weights_type;
+
+	/// "_offsets[u]" is the index of the first edge of 'u'.
+	/// Has "N+1" elements, the last one equals to number of edges.
+	offsets_type _offsets;
+
+	/// Targets of all the edges, grouped by their source vertex.
+	targets_type _targets;
+
+	/// Weights of all the edges, parallel to '_targets'.
+	weights_type _weights;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty graph.
+	WeightedCsrGraph()
+		: _offsets( 1, 0 )
+		{}
+
+	/// Constructor
+	/// Freezes provided adjacency list 'g', preserving order of edges.
+	explicit WeightedCsrGraph( const WeightedAdjacencyList& g )
+		: _offsets( g.size() + 1, 0 ) {
+		const int N = g.size();  // Number of vertices
+		for ( int u = 0; u < N; ++u )
+			_offsets[ u+1 ] = _offsets[ u ] + (int)g._adj[ u ].size();
+		_targets.reserve( _offsets[ N ] );
+		_weights.reserve( _offsets[ N ] );
+		for ( int u = 0; u < N; ++u )
+			for ( const auto& e : g._adj[ u ] ) {
+				_targets.push_back( e.first );
+				_weights.push_back( e.second );
+			}
+	}
+
+	/// Returns number of vertices in this graph.
+	int size() const
+		{ return (int)_offsets.size() - 1; }
+
+	/// Returns number of edges in this graph.
+	int numEdges() const
+		{ return (int)_targets.size(); }
+
+	/// Returns number of edges, which start at vertex 'u'.
+	int degree( int u ) const
+		{ return _offsets[ u+1 ] - _offsets[ u ]; }
+
+	/// Returns targets of all the edges, which start at vertex 'u'.
+	std::span< const int > neighbors( int u ) const
+		{ return std::span< const int >(
+				_targets.data() + _offsets[ u ],
+				_targets.data() + _offsets[ u+1 ] ); }
+
+	/// Returns weights of all the edges, which start at vertex 'u',
+	/// in the same order as "neighbors(u)".
+	std::span< const adj_list_weight_type > weights( int u ) const
+		{ return std::span< const adj_list_weight_type >(
+				_weights.data() + _offsets[ u ],
+				_weights.data() + _offsets[ u+1 ] ); }
+
+	/// Returns the reversed graph, where every edge "(u,v)" becomes
+	/// "(v,u)" with the same weight. Works in O(V+E), by counting sort
+	/// of edges by target.
+	WeightedCsrGraph transposed() const {
+		const int N = size();  // Number of vertices
+		WeightedCsrGraph result;
+		result._offsets.assign( N + 1, 0 );
+		for ( int v : _targets )
+			++result._offsets[ v+1 ];
+		for ( int v = 0; v < N; ++v )
+			result._offsets[ v+1 ] += result._offsets[ v ];
+		result._targets.resize( _targets.size() );
+		result._weights.resize( _weights.size() );
+		offsets_type pos( result._offsets.cbegin(), result._offsets.cend() - 1 );
+		for ( int u = 0; u < N; ++u )
+			for ( int e = _offsets[ u ]; e < _offsets[ u+1 ]; ++e ) {
+				const int i = pos[ _targets[ e ] ]++;
+				result._targets[ i ] = u;
+				result._weights[ i ] = _weights[ e ];
+			}
+		return result;
+	}
+
+	/// Prints this graph to the console, in the same form as
+	/// "WeightedAdjacencyList::print()".
+	void print() const
+	{
+		using namespace std;
+		const int N = size();
+		for ( int i = 0; i < N; ++i ) {
+			cout << "  " << char('A'+i) << ": [";
+			for ( int e = _offsets[ i ]; e < _offsets[ i+1 ]; ++e )
+				cout << " (" << char('A'+_targets[e]) << "," << _weights[e] << ")";
+			cout << " ]" << endl;
+		}
+	}
+};
+
+
+#endif // _WEIGHTED_CSR_GRAPH_HPP
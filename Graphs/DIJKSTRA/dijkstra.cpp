@@ -20,17 +20,45 @@
 #include <iostream>
 #include <iomanip>
 #include <queue>
+#include <random>
+#include <chrono>
+#include <cassert>
+#include <string>
+#include <filesystem>
 
 
 #include "WeightedAdjacencyMatrix.hpp"
+#include "WeightedAdjacencyList.hpp"
+#include "WeightedCsrGraph.hpp"
+#include "IndexedDaryHeap.hpp"
+#include "DialQueue.hpp"
+#include "RadixHeap.hpp"
+#include "TraversalWorkspace.hpp"
+#include "MappedCsrGraph.hpp"
+
+
+/// Checks if sparse graph 'g' has weights of edges. Only 'MappedCsrGraph'
+/// may have none, if its file was written from an unweighted graph.
+template< typename Graph >
+bool hasEdgeWeights( const Graph& g )
+{
+	if constexpr ( requires { g.hasWeights(); } )
+		return g.hasWeights();
+	else
+		return true;
+}
 
 
 /// This class runs Dijkstra's shortest algorithm, and remembers all 
 /// the results.
+/// The graph is not copied, and all the buffers are kept between the 
+/// runs, so repeated runs on graphs of the same size allocate nothing.
 struct DijkstraSP
 {
-	/// The graph, on which the algorithm is being run.
-	WeightedAdjacencyMatrix _g;
+	/// The matrix, on which the algorithm was run last time, or null if it
+	/// was run on another representation. It is not owned, and must outlive
+	/// following calls to "getShortestPathTo_NoPrev()".
+	const WeightedAdjacencyMatrix* _g = nullptr;
 
 	/// The source vertex, from which the algorithm starts.
 	int _source;
@@ -47,6 +75,19 @@ struct DijkstraSP
 	/// "_source" to "v".
 	std::vector< int > _prev;
 
+	/// The queue of temporary vertices, used by "run()" on sparse graphs.
+	IndexedDaryHeap< double > _heap;
+
+protected:
+	/// Prepares for running from 'source' on a graph with 'N' vertices,
+	/// reusing memory of the previous run.
+	void reset( int N, int source ) {
+		_source = source;
+		_dist.assign( N, WEIGHTED_ADJ_MATRIX_INF );
+		_is_final.assign( N, false );
+		_prev.assign( N, -1 );
+	}
+
 public:
 	/// Runs Dijkstra's shortest path algorithm on provided graph 'g', 
 	/// from given vertex 'source'.
@@ -54,12 +95,9 @@ public:
 	{
 		static const double INF = WEIGHTED_ADJ_MATRIX_INF;
 		// Prepare
-		_g = g;
-		_source = source;
-		const int N = _g.size();  // Number of vertices
-		_dist = std::vector< double >( N, INF );
-		_is_final = std::vector< bool >( N, false );
-		_prev = std::vector< int >( N, -1 );
+		_g = &g;
+		const int N = g.size();  // Number of vertices
+		reset( N, source );
 		// Start from vertex '_source'
 		_dist[ _source ] = 0;
 		// Continuously discover new vertices with final distance
@@ -77,9 +115,9 @@ public:
 			// from it are examined
 			_is_final[ min_vertex ] = true;
 			for ( int v = 0; v < N; ++v )
-				if ( _g._m[ min_vertex ][ v ] && _is_final[ v ] == false )
-					if ( _dist[min_vertex] + _g._m[min_vertex][v] < _dist[v] ) {
-						_dist[v] = _dist[min_vertex] + _g._m[min_vertex][v];
+				if ( g._m[ min_vertex ][ v ] && _is_final[ v ] == false )
+					if ( _dist[min_vertex] + g._m[min_vertex][v] < _dist[v] ) {
+						_dist[v] = _dist[min_vertex] + g._m[min_vertex][v];
 						_prev[v] = min_vertex;
 					}
 		}
@@ -89,7 +127,7 @@ public:
 	/// If vertex is not reachable, prints '-' there.
 	void printDistances() const
 	{
-		const int N = _g.size();
+		const int N = (int)_dist.size();
 		// Print labels
 		std::cout << " |";
 		for ( int v = 0; v < N; ++v )
@@ -108,7 +146,7 @@ public:
 	/// Prints on one line all vertices which are reachable from "_source".
 	void printReachableVertices() const
 	{
-		const int N = _g.size();
+		const int N = (int)_dist.size();
 		std::cout << " {";
 		for (int v = 0; v < N; ++v)
 		{
@@ -133,6 +171,7 @@ public:
 
 	std::vector<int> getShortestPathTo_NoPrev(int target) const
 	{
+		assert(_g != nullptr);
 		if (_dist[target] == WEIGHTED_ADJ_MATRIX_INF)
 			return {};
 		std::vector<int> path;
@@ -142,9 +181,9 @@ public:
 			path.insert(path.begin(), current);
 			double current_dist = _dist[current];
 			bool found = false;
-			for (int u = 0; u < _g.size(); ++u)
+			for (int u = 0; u < _g->size(); ++u)
 			{
-				if (_dist[u] + _g._m[u][current] == current_dist)
+				if (_dist[u] + _g->_m[u][current] == current_dist)
 				{
 					current = u;
 					found = true;
@@ -161,13 +200,9 @@ public:
 	void run_q(const WeightedAdjacencyMatrix& g, int source)
 	{
 		static const double INF = WEIGHTED_ADJ_MATRIX_INF;
-		_g = g;
-		_source = source;
-		const int N = _g.size();
-
-		_dist = std::vector<double>(N, INF);
-		_prev = std::vector<int>(N, -1);
-		_is_final = std::vector<bool>(N, false);
+		_g = &g;
+		const int N = g.size();
+		reset(N, source);
 
 		std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> pq;
 
@@ -183,8 +218,8 @@ public:
 			_is_final[u] = true;
 
 			for (int v = 0; v < N; ++v) {
-				if (_g._m[u][v] != INF && !_is_final[v]) {
-					double new_dist = _dist[u] + _g._m[u][v];
+				if (g._m[u][v] != INF && !_is_final[v]) {
+					double new_dist = _dist[u] + g._m[u][v];
 					if (new_dist < _dist[v]) {
 						_dist[v] = new_dist;
 						_prev[v] = u;
@@ -195,8 +230,150 @@ public:
 		}
 	}
 
+	/// Runs Dijkstra's shortest path algorithm on sparse graph 'g' (either
+	/// 'WeightedCsrGraph', 'MappedCsrGraph' or 'WeightedAdjacencyList'),
+	/// from given vertex 'source', keeping the temporary vertices in 'queue'.
+	/// The 'Queue' policy must provide "reset(N)", "empty()", "pop()" and
+	/// "pushOrDecrease(v,key)", for example:
+	///    IndexedDaryHeap - comparison based, works for any weights,
+	///    DialQueue, RadixHeap - for non-negative integer weights only.
+	/// A 'DialQueue' must be created with 'maxWeight' not less than weight
+	/// of every edge of 'g', which is checked only by an assertion.
+	/// Every vertex is popped at most once.
+	/// Returns false (leaving all the vertices unreachable), if 'g' has no
+	/// weights of edges.
+	template< typename Graph, typename Queue >
+	bool run( const Graph& g, int source, Queue& queue )
+	{
+		typedef typename Queue::key_type key_type;
+		_g = nullptr;
+		const int N = g.size();  // Number of vertices
+		reset( N, source );
+		if ( ! hasEdgeWeights( g ) )
+			return false;
+		queue.reset( N );  // The temporary vertices
+		_dist[ _source ] = 0;
+		queue.pushOrDecrease( _source, key_type( 0 ) );
+		while ( ! queue.empty() ) {
+			// Distance of the closest temporary vertex becomes final
+			const int u = queue.pop();
+			_is_final[ u ] = true;
+			const auto weights = g.weights( u );
+			auto weight = weights.begin();
+			for ( int v : g.neighbors( u ) ) {
+				const adj_list_weight_type w = *weight++;
+				if ( _is_final[ v ] )
+					continue;
+				const double new_dist = _dist[ u ] + w;
+				if ( new_dist < _dist[ v ] ) {
+					_dist[ v ] = new_dist;
+					_prev[ v ] = u;
+					queue.pushOrDecrease( v, key_type( new_dist ) );
+				}
+			}
+		}
+		return true;
+	}
+
+	/// Same as above, with an indexed 4-ary heap, where distance of a 
+	/// vertex is decreased in place: O((V+E) log V).
+	void run( const WeightedCsrGraph& g, int source )
+		{ run( g, source, _heap ); }
+	bool run( const MappedCsrGraph& g, int source )
+		{ return run( g, source, _heap ); }
+	void run( const WeightedAdjacencyList& g, int source )
+		{ run( g, source, _heap ); }
+
+};
+
+
+/// This class answers point-to-point shortest path queries, by running
+/// Dijkstra's algorithm simultaneously from the source on the graph, and
+/// from the target on the reversed graph.
+/// The search stops as soon as the sum of the minimal temporary distances
+/// of both sides is not less than the best path found via a vertex, which
+/// was reached by both of them.
+/// Like in 'LocalDijkstraSP', the state is kept in workspaces with epoch
+/// stamps, and the heaps are reused, so a query costs only as much as the
+/// regions it explores, and not O(N).
+struct BidirectionalDijkstraSP
+{
+	/// Length of the shortest path, found by the last query.
+	double _distance;
+
+	/// Number of vertices, which got final distance in the last query,
+	/// from both sides.
+	int _settled;
+
+	/// State of both sides of the last query. Side 0 keeps distances from
+	/// the source and previous vertices on the path from it, while side 1
+	/// keeps distances to the target and next vertices on the path to it.
+	TraversalWorkspace< double > _ws[ 2 ];
 
+	/// The temporary vertices of both sides.
+	IndexedDaryHeap< double > _heaps[ 2 ];
 
+public:
+	/// Calculates and returns shortest path from 's' to 't' in graph 'g',
+	/// where 'reversed' must be "g.transposed()".
+	/// Returns empty path, if 't' is not reachable from 's'.
+	std::vector< int > run( const WeightedCsrGraph& g, 
+			const WeightedCsrGraph& reversed, int s, int t )
+	{
+		static const double INF = WEIGHTED_ADJ_MATRIX_INF;
+		const int N = g.size();  // Number of vertices
+		const WeightedCsrGraph* graphs[ 2 ] = { &g, &reversed };
+		for ( int side = 0; side < 2; ++side ) {
+			_ws[ side ].begin( N );
+			if ( (int)_heaps[ side ]._pos.size() != N )
+				_heaps[ side ].reset( N );
+			else
+				_heaps[ side ].clear();
+		}
+		_ws[ 0 ].visit( s, 0, -1 );
+		_heaps[ 0 ].pushOrDecrease( s, 0 );
+		_ws[ 1 ].visit( t, 0, -1 );
+		_heaps[ 1 ].pushOrDecrease( t, 0 );
+		_distance = s == t ? 0 : INF;
+		_settled = 0;
+		int meet = s == t ? s : -1;  // The vertex, where both paths meet
+		while ( ! _heaps[ 0 ].empty() && ! _heaps[ 1 ].empty() ) {
+			const double top0 = _heaps[ 0 ].key( _heaps[ 0 ].top() );
+			const double top1 = _heaps[ 1 ].key( _heaps[ 1 ].top() );
+			if ( top0 + top1 >= _distance )
+				break;  // No shorter path can be found
+			// Advance the side with smaller distance
+			const int side = top0 <= top1 ? 0 : 1;
+			TraversalWorkspace< double >& ws = _ws[ side ];
+			const TraversalWorkspace< double >& other = _ws[ 1-side ];
+			const int u = _heaps[ side ].pop();
+			ws.setFinal( u );
+			++_settled;
+			const std::span< const int > targets = graphs[ side ]->neighbors( u );
+			const std::span< const adj_list_weight_type > weights = graphs[ side ]->weights( u );
+			for ( int e = 0; e < (int)targets.size(); ++e ) {
+				const int v = targets[ e ];
+				const double new_dist = ws.distance( u ) + weights[ e ];
+				if ( ! ws.isVisited( v ) || ( ! ws.isFinal( v ) && new_dist < ws.distance( v ) ) ) {
+					ws.visit( v, new_dist, u );
+					_heaps[ side ].pushOrDecrease( v, new_dist );
+				}
+				// Check the path, which passes through edge (u,v)
+				if ( other.isVisited( v ) 
+						&& new_dist + other.distance( v ) < _distance ) {
+					_distance = new_dist + other.distance( v );
+					meet = v;
+				}
+			}
+		}
+		if ( meet == -1 )
+			return {};
+		// Glue the path from 's' to 'meet' with the path from 'meet' to 't'
+		std::vector< int > path = _ws[ 0 ].getPathTo( meet );
+		for ( int at = _ws[ 1 ].parent( meet ); at != -1; at = _ws[ 1 ].parent( at ) )
+			path.push_back( at );
+		return path;
+	}
 };
 
 
@@ -210,6 +387,108 @@ void printPath( const std::vector< int >& path )
 }
 
 
+/// This class answers many point-to-point shortest path queries on one
+/// large graph, where the target is close to the source. The state is kept
+/// in a workspace with epoch stamps, and the heap is emptied by removing
+/// only its remaining vertices, so a query doesn't pay O(N) for resetting
+/// them, and costs only as much as the region it explores.
+struct LocalDijkstraSP
+{
+	/// State of the last query.
+	TraversalWorkspace< double > _ws;
+
+	/// The temporary vertices.
+	IndexedDaryHeap< double > _heap;
+
+	/// Runs Dijkstra's SP on graph 'g' (either 'WeightedCsrGraph' or
+	/// 'MappedCsrGraph') from vertex 'source', until distance of vertex
+	/// 'target' becomes final.
+	/// Returns that distance, or "WEIGHTED_ADJ_MATRIX_INF" if 'target' is
+	/// not reachable, or -1 (without running) if 'g' has no weights of edges.
+	template< typename Graph >
+	double run( const Graph& g, int source, int target )
+	{
+		const int N = g.size();  // Number of vertices
+		_ws.begin( N );
+		if ( ! hasEdgeWeights( g ) )
+			return -1;
+		if ( (int)_heap._pos.size() != N )
+			_heap.reset( N );
+		else
+			_heap.clear();
+		_ws.visit( source, 0, -1 );
+		_heap.pushOrDecrease( source, 0 );
+		while ( ! _heap.empty() ) {
+			const int u = _heap.pop();
+			_ws.setFinal( u );
+			if ( u == target )
+				return _ws.distance( u );
+			const std::span< const int > targets = g.neighbors( u );
+			const std::span< const adj_list_weight_type > weights = g.weights( u );
+			for ( int e = 0; e < (int)targets.size(); ++e ) {
+				const int v = targets[ e ];
+				const double new_dist = _ws.distance( u ) + weights[ e ];
+				if ( ! _ws.isVisited( v ) || ( ! _ws.isFinal( v ) && new_dist < _ws.distance( v ) ) ) {
+					_ws.visit( v, new_dist, u );
+					_heap.pushOrDecrease( v, new_dist );
+				}
+			}
+		}
+		return WEIGHTED_ADJ_MATRIX_INF;
+	}
+
+	/// Returns shortest path from the source of the last query to 't'.
+	std::vector< int > getShortestPathTo( int t ) const
+		{ return _ws.isFinal( t ) ? _ws.getPathTo( t ) : std::vector< int >(); }
+};
+
+
+/// Generates a random 'rows*cols' grid graph, where every cell is 
+/// connected to its neighbors by edges of random weights "1..maxWeight".
+WeightedCsrGraph generateGridGraph( int rows, int cols, int maxWeight )
+{
+	std::mt19937 rng( 12345 );
+	std::uniform_int_distribution< int > weight( 1, maxWeight );
+	WeightedAdjacencyList g( rows * cols );
+	for ( int r = 0; r < rows; ++r )
+		for ( int c = 0; c < cols; ++c ) {
+			const int u = r * cols + c;
+			// Edges are added directly, as they are known to be distinct
+			if ( c + 1 < cols ) {
+				g._adj[ u ].push_back( { u + 1, weight( rng ) } );
+				g._adj[ u + 1 ].push_back( { u, weight( rng ) } );
+			}
+			if ( r + 1 < rows ) {
+				g._adj[ u ].push_back( { u + cols, weight( rng ) } );
+				g._adj[ u + cols ].push_back( { u, weight( rng ) } );
+			}
+		}
+	return WeightedCsrGraph( g );
+}
+
+
+/// Runs Dijkstra's SP on 'g' from vertex 0 with provided 'queue', and 
+/// prints the consumed time along with a checksum of the distances.
+template< typename Queue >
+void benchmarkQueue( const char* name, const WeightedCsrGraph& g, Queue& queue )
+{
+	DijkstraSP runner;
+	const auto start = std::chrono::steady_clock::now();
+	runner.run( g, 0, queue );
+	const auto finish = std::chrono::steady_clock::now();
+	double checksum = 0;
+	for ( double d : runner._dist )
+		if ( d != WEIGHTED_ADJ_MATRIX_INF )
+			checksum += d;
+	const std::streamsize precision = std::cout.precision( 15 );
+	std::cout << "  " << std::setw( 16 ) << std::left << name << std::right
+			<< std::setw( 8 ) << std::chrono::duration_cast< std::chrono::milliseconds >(
+					finish - start ).count() << " ms"
+			<< "   (checksum " << checksum << ")" << std::endl;
+	std::cout.precision( precision );
+}
+
+
 using std::cout;
 using std::endl;
 
@@ -283,5 +562,132 @@ int main( int argc, char* argv[] )
 		printPath( runner.getShortestPathTo( 0 ) );
 	}
 
+	// The same graph, represented by adjacency list
+	WeightedAdjacencyList h( 'U' - 'A' + 1 );
+	h.addUndirectedEdge( 'U', 'P', 6 );
+	h.addUndirectedEdge( 'P', 'Q', 7 );
+	h.addUndirectedEdge( 'P', 'B', 4 );
+	h.addUndirectedEdge( 'Q', 'H', 19 );
+	h.addUndirectedEdge( 'A', 'B', 8 );
+	h.addUndirectedEdge( 'B', 'H', 1 );
+	h.addUndirectedEdge( 'A', 'C', 2 );
+	h.addUndirectedEdge( 'K', 'H', 8 );
+	h.addUndirectedEdge( 'C', 'E', 1 );
+	h.addUndirectedEdge( 'E', 'F', 9 );
+	h.addUndirectedEdge( 'F', 'K', 2 );
+	h.addUndirectedEdge( 'R', 'C', 14 );
+	h.addUndirectedEdge( 'E', 'S', 3 );
+	h.addUndirectedEdge( 'K', 'T', 22 );
+	h.addUndirectedEdge( 'R', 'S', 8 );
+	h.addUndirectedEdge( 'S', 'T', 6 );
+
+	cout << "\t Running heap-based Dijkstra's SP on adjacency list from vertex 'A' ..." << endl;
+	{
+		DijkstraSP runner;
+		runner.run( h, 0 );  // '0' corresponds to 'A'.
+		runner.printDistances();
+
+		std::cout << "Shortest path to 'K': ";
+		printPath( runner.getShortestPathTo( 'K'-'A' ) );
+	}
+
+	cout << "\t Running bidirectional Dijkstra's SP from 'A' to 'T' ..." << endl;
+	{
+		const WeightedCsrGraph csr( h );
+		BidirectionalDijkstraSP runner;
+		std::cout << "Shortest path : ";
+		printPath( runner.run( csr, csr.transposed(), 0, 'T'-'A' ) );
+		std::cout << "Its length : " << runner._distance 
+				<< ", settled vertices : " << runner._settled << std::endl;
+	}
+
+	cout << "\t Comparing priority queues on a grid with weights 1..10 ..." << endl;
+	{
+		const int MAX_WEIGHT = 10;
+		const WeightedCsrGraph grid = generateGridGraph( 1000, 1000, MAX_WEIGHT );
+		IndexedDaryHeap< double, 2 > binary;
+		IndexedDaryHeap< double, 4 > quaternary;
+		DialQueue dial( 0, MAX_WEIGHT );
+		RadixHeap radix;
+		benchmarkQueue( "binary heap", grid, binary );
+		benchmarkQueue( "4-ary heap", grid, quaternary );
+		benchmarkQueue( "Dial's buckets", grid, dial );
+		benchmarkQueue( "radix heap", grid, radix );
+	}
+
+	cout << "\t Running local Dijkstra's SP from 'A' to 'K' ..." << endl;
+	{
+		const WeightedCsrGraph csr( h );
+		LocalDijkstraSP runner;
+		cout << "Distance : " << runner.run( csr, 0, 'K'-'A' ) << endl;
+		std::cout << "Shortest path : ";
+		printPath( runner.getShortestPathTo( 'K'-'A' ) );
+	}
+
+	cout << "\t Saving the graph to file, and running Dijkstra's SP on it ..." << endl;
+	{
+		const std::string path = ( std::filesystem::temp_directory_path() / "dijkstra_graph.csr" ).string();
+		const WeightedCsrGraph csr( h );
+		cout << "Written : " << writeCsrGraphFile( path, csr ) << endl;
+		const MappedCsrGraph mapped( path );
+		cout << "Mapped : " << mapped.isOpen() << ", with weights : " << mapped.hasWeights()
+				<< ", checksum is valid : " << mapped.verify() << endl;
+		DijkstraSP fromMemory, fromFile;
+		fromMemory.run( csr, 0 );
+		fromFile.run( mapped, 0 );
+		cout << "Same distances : " << ( fromMemory._dist == fromFile._dist ) << endl;
+		LocalDijkstraSP local;
+		cout << "Local distance from 'A' to 'K' : " << local.run( mapped, 0, 'K'-'A' ) << endl;
+		std::filesystem::remove( path );
+	}
+
+	cout << "\t Benchmarking local queries on a grid with weights 1..10 ..." << endl;
+	{
+		using namespace std::chrono;
+		const int SIDE = 1000, QUERIES = 10000, FULL_RUNS = 10;
+		const WeightedCsrGraph grid = generateGridGraph( SIDE, SIDE, 10 );
+		std::mt19937 rng( 42 );
+		std::uniform_int_distribution< int > coord( 0, SIDE - 9 ), shift( 0, 8 );
+		std::vector< std::pair< int, int > > queries( QUERIES );
+		for ( auto& q : queries ) {
+			const int r = coord( rng ), c = coord( rng );
+			q = { r * SIDE + c, ( r + shift( rng ) ) * SIDE + c + shift( rng ) };
+		}
+		LocalDijkstraSP local;
+		double localSum = 0;
+		auto start = steady_clock::now();
+		for ( const auto& q : queries )
+			localSum += local.run( grid, q.first, q.second );
+		const double localUs = duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count() / 1000.0 / QUERIES;
+		const WeightedCsrGraph reversed = grid.transposed();
+		BidirectionalDijkstraSP bidirectional;
+		double bidirectionalSum = 0;
+		start = steady_clock::now();
+		for ( const auto& q : queries ) {
+			bidirectional.run( grid, reversed, q.first, q.second );
+			bidirectionalSum += bidirectional._distance;
+		}
+		const double bidirectionalUs = duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count() / 1000.0 / QUERIES;
+		DijkstraSP full;
+		double fullSum = 0, localPartSum = 0;
+		start = steady_clock::now();
+		for ( int i = 0; i < FULL_RUNS; ++i ) {
+			full.run( grid, queries[ i ].first );
+			fullSum += full._dist[ queries[ i ].second ];
+		}
+		const double fullUs = duration_cast< nanoseconds >( 
+				steady_clock::now() - start ).count() / 1000.0 / FULL_RUNS;
+		for ( int i = 0; i < FULL_RUNS; ++i )  // Not timed
+			localPartSum += local.run( grid, queries[ i ].first, queries[ i ].second );
+		cout << "  Local query   : " << localUs << " us (sum of distances " 
+				<< localSum << ")" << endl;
+		cout << "  Bidirectional : " << bidirectionalUs << " us (sum of distances " 
+				<< bidirectionalSum << ")" << endl;
+		cout << "  Full Dijkstra : " << fullUs << " us" << endl;
+		cout << "  Same distances : " << ( fullSum == localPartSum ) << endl;
+	}
+
 	return 0;
 }
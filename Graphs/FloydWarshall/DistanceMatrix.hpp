@@ -0,0 +1,68 @@
+
+#ifndef _DISTANCE_MATRIX_HPP
+#define _DISTANCE_MATRIX_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include "WeightedAdjacencyMatrix.hpp"
+
+
+/// This class represents a square matrix of distances (or weights) between
+/// all pairs of vertices, stored contiguously row after row.
+/// Unlike "WeightedAdjacencyMatrix::_m", where every row is a separate
+/// vector, rows follow each other in memory, so square tiles of the
+/// matrix can be processed while staying in the cache.
+struct DistanceMatrix
+{
+	/// Number of vertices.
+	int _n;
+
+	/// The distances: "_d[ i*_n + j ]" is the distance from 'i' to 'j'.
+	/// If there is no path, it is "WEIGHTED_ADJ_MATRIX_INF".
+	std::vector< adj_matrix_weight_type > _d;
+
+public:
+	/// [Default] constructor
+	/// Creates 'N*N' matrix, with all the distances being infinite.
+	explicit DistanceMatrix( int N = 0 )
+		: _n( N ),
+		  _d( (std::size_t)N * N, WEIGHTED_ADJ_MATRIX_INF )
+		{}
+
+	/// Constructor
+	/// Copies weights of edges of graph 'g'.
+	explicit DistanceMatrix( const WeightedAdjacencyMatrix& g )
+		: DistanceMatrix( g.size() ) {
+		for ( int i = 0; i < _n; ++i )
+			std::copy( g._m[i].cbegin(), g._m[i].cend(), row( i ) );
+	}
+
+	/// Number of vertices.
+	int size() const
+		{ return _n; }
+
+	/// Returns row 'i' of the matrix.
+	adj_matrix_weight_type* row( int i )
+		{ return _d.data() + (std::size_t)i * _n; }
+	const adj_matrix_weight_type* row( int i ) const
+		{ return _d.data() + (std::size_t)i * _n; }
+
+	/// Returns distance from 'i' to 'j'.
+	adj_matrix_weight_type& at( int i, int j )
+		{ return _d[ (std::size_t)i * _n + j ]; }
+	adj_matrix_weight_type at( int i, int j ) const
+		{ return _d[ (std::size_t)i * _n + j ]; }
+
+	/// Copies the distances to the graph 'g', which will have an edge
+	/// for every finite distance.
+	void copyTo( WeightedAdjacencyMatrix& g ) const {
+		g.setSize( _n );
+		for ( int i = 0; i < _n; ++i )
+			std::copy( row( i ), row( i ) + _n, g._m[i].begin() );
+	}
+};
+
+
+#endif // _DISTANCE_MATRIX_HPP
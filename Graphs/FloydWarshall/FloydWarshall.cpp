@@ -33,8 +33,18 @@
  */
 
 
+#include <vector>
+#include <limits>
+#include <thread>
+#include <barrier>
+
 #include "WeightedAdjacencyMatrix.hpp"
 #include "WeightedAdjacencyList.hpp"
+#include "WeightedCsrGraph.hpp"
+#include "DistanceMatrix.hpp"
+#include "MinPlusKernels.hpp"
+#include "IndexedDaryHeap.hpp"
+#include "NextHopMatrix.hpp"
 
 
 /// Alters provided graph 'g', so the vertex 'k' can no longer be 
@@ -43,11 +53,8 @@ void discardVertex( WeightedAdjacencyMatrix& g, int k )
 {
 	const int N = g.size();  // Number of vertices
 	for ( int i = 0; i < N; ++i )  // Consider all incoming edges
-		if ( g.hasEdge( i, k ) )
-			for ( int j = 0; j < N; ++j )  // And all outgoing edges
-				if ( g.hasEdge( k, j ) )
-					if ( g._m[i][k] + g._m[k][j] < g._m[i][j] )
-						g._m[i][j] = g._m[i][k] + g._m[k][j];  // Discard
+		if ( g.hasEdge( i, k ) )  // And all outgoing edges, by a vector kernel
+			minPlusRow( g._m[i].data(), g._m[k].data(), g._m[i][k], N );
 }
 
 
@@ -133,6 +140,79 @@ void floydWarshallShortestPaths(WeightedAdjacencyList& g)
 }
 
 
+/// Runs Floyd-Warshall all-pair shortest paths algorithm on the frozen
+/// graph 'g', and returns the matrix of shortest distances.
+/// The edges are copied to the matrix by one scan of 'g'.
+WeightedAdjacencyMatrix floydWarshallShortestPaths( const WeightedCsrGraph& g )
+{
+	const int N = g.size();  // Number of vertices
+	WeightedAdjacencyMatrix result( N );
+	for ( int u = 0; u < N; ++u ) {
+		const std::span< const int > targets = g.neighbors( u );
+		const std::span< const adj_list_weight_type > weights = g.weights( u );
+		for ( int e = 0; e < (int)targets.size(); ++e )
+			if ( weights[ e ] < result._m[ u ][ targets[ e ] ] )
+				result._m[ u ][ targets[ e ] ] = weights[ e ];
+	}
+	floydWarshallShortestPaths( result );
+	return result;
+}
+
+/// Size of square tiles, processed by "floydWarshallShortestPathsBlocked()".
+/// Three tiles of 64*64 ints occupy 48KB, so they stay in L1/L2 cache.
+static const int FLOYD_WARSHALL_TILE = 64;
+
+
+/// Relaxes all distances of the tile of 'd' with rows "ib..ib+T-1" and
+/// columns "jb..jb+T-1", through the vertices "kb..kb+T-1", i.e.:
+///    d[i][j] = min( d[i][j], d[i][k] + d[k][j] ).
+/// The vertices 'k' are iterated in the outermost loop, so it is correct
+/// also when the tile itself is on row or column 'kb'.
+void relaxTile( DistanceMatrix& d, int ib, int jb, int kb, int T )
+{
+	const int N = d.size();  // Number of vertices
+	const int iEnd = std::min( ib + T, N );
+	const int jEnd = std::min( jb + T, N );
+	const int kEnd = std::min( kb + T, N );
+	for ( int k = kb; k < kEnd; ++k ) {
+		const adj_matrix_weight_type* dk = d.row( k );
+		for ( int i = ib; i < iEnd; ++i ) {
+			adj_matrix_weight_type* di = d.row( i );
+			const adj_matrix_weight_type dik = di[ k ];
+			if ( dik == WEIGHTED_ADJ_MATRIX_INF )
+				continue;  // There is no path 'i'-->'k'
+			minPlusRow( di + jb, dk + jb, dik, jEnd - jb );
+		}
+	}
+}
+
+
+/// Runs Floyd-Warshall all-pair shortest paths algorithm on the distances
+/// 'd', tile by tile. For every range of 'T' intermediate vertices, first
+/// the diagonal tile is relaxed, then the tiles of its row and column, and
+/// then all the remaining tiles. Results are same as of
+/// "floydWarshallShortestPaths()".
+void floydWarshallShortestPathsBlocked( DistanceMatrix& d, 
+		int T = FLOYD_WARSHALL_TILE )
+{
+	const int N = d.size();  // Number of vertices
+	for ( int i = 0; i < N; ++i )
+		d.at( i, i ) = 0;  // No cost to travel 'i'-->'i'
+	for ( int kb = 0; kb < N; kb += T ) {
+		relaxTile( d, kb, kb, kb, T );
+		for ( int b = 0; b < N; b += T )
+			if ( b != kb ) {
+				relaxTile( d, kb, b, kb, T );  // Tiles of the pivot row
+				relaxTile( d, b, kb, kb, T );  // Tiles of the pivot column
+			}
+		for ( int ib = 0; ib < N; ib += T )
+			if ( ib != kb )
+				for ( int jb = 0; jb < N; jb += T )
+					if ( jb != kb )
+						relaxTile( d, ib, jb, kb, T );
+	}
+}
+
 
 /// How the glues-matrix is represented.
 /// If "glues[i][j] == -1", it means that 'i' is directly connected to 'j'.
@@ -174,15 +254,234 @@ void floydWarshallShortestPathsWithGlues(
 	}
 	for (int k = 0; k < N; ++k)
 		for (int i = 0; i < N; ++i)
-			for (int j = 0; j < N; ++j)
-				if (g._m[i][k] != WEIGHTED_ADJ_MATRIX_INF && g._m[k][j] != WEIGHTED_ADJ_MATRIX_INF)
-					if (g._m[i][k] + g._m[k][j] < g._m[i][j]) {
-						g._m[i][j] = g._m[i][k] + g._m[k][j];
-						glues[i][j] = k;
-					}
+			if (g._m[i][k] != WEIGHTED_ADJ_MATRIX_INF)
+				minPlusRow(g._m[i].data(), g._m[k].data(), g._m[i][k], N,
+						glues[i].data(), k);
+}
+
+
+/// Builds the next-hop matrix of shortest paths, from matrix 'g' and glues
+/// matrix 'glues', filled by "floydWarshallShortestPathsWithGlues()".
+/// Works in O(N^2): "next(i,j)" equals to "next(i,glues[i][j])", so every
+/// row is resolved by following chains of glues, each entry only once.
+NextHopMatrix buildNextHops( 
+		const WeightedAdjacencyMatrix& g, const glues_matrix_type& glues )
+{
+	const int N = g.size();  // Number of vertices
+	NextHopMatrix next( N );
+	std::vector< int > row( N );  // Next hops of the current row, -2 if unknown
+	std::vector< int > chain;  // Targets, waiting for their glue to be resolved
+	for ( int i = 0; i < N; ++i ) {
+		for ( int j = 0; j < N; ++j )
+			row[ j ] = i == j ? i 
+					: ! g.hasEdge( i, j ) ? -1 
+					: glues[i][j] == -1 ? j  // 'i' is directly connected to 'j'
+					: -2;
+		for ( int j = 0; j < N; ++j ) {
+			for ( int at = j; row[ at ] == -2; at = glues[i][at] )
+				chain.push_back( at );
+			for ( ; ! chain.empty(); chain.pop_back() )
+				row[ chain.back() ] = row[ glues[i][ chain.back() ] ];
+			next.setNext( i, j, row[ j ] );
+		}
+	}
+	return next;
+}
+
+/// Runs Floyd-Warshall all-pair shortest paths algorithm on the provided
+/// graph 'g', and fills the next-hop matrix 'next' while relaxing: when
+/// path "i-->k-->j" becomes shorter, "next(i,j)" becomes "next(i,k)".
+/// So no glues matrix of 'int'-s is needed at all, and paths take 2 or 4
+/// bytes per pair of vertices. Rows are relaxed by the next-hop blend of
+/// the dispatched min-plus kernels.
+void floydWarshallShortestPathsWithNextHops( 
+		WeightedAdjacencyMatrix& g, NextHopMatrix& next )
+{
+	const int N = g.size();  // Number of vertices
+	next = NextHopMatrix( N );
+	next.visitEntries( [&]( auto& entries ) {
+		typedef typename std::decay_t< decltype( entries ) >::value_type entry_type;
+		for ( int i = 0; i < N; ++i ) {
+			g._m[i][i] = 0;
+			entry_type* ni = entries.data() + (std::size_t)i * N;
+			for ( int j = 0; j < N; ++j )
+				if ( g._m[i][j] != WEIGHTED_ADJ_MATRIX_INF )
+					ni[ j ] = (entry_type)j;
+		}
+		for ( int k = 0; k < N; ++k )
+			for ( int i = 0; i < N; ++i ) {
+				const adj_matrix_weight_type dik = g._m[i][k];
+				if ( i == k || dik == WEIGHTED_ADJ_MATRIX_INF )
+					continue;
+				entry_type* ni = entries.data() + (std::size_t)i * N;
+				minPlusRow( g._m[i].data(), g._m[k].data(), dik, N, ni, ni[ k ] );
+			}
+	} );
+}
+
+/// Runs 'work(t)' on 'numThreads' threads, for "t = 0..numThreads-1", and
+/// waits for all of them. If 'numThreads' is 0, all hardware threads are used.
+template< typename Work >
+void runOnThreads( int numThreads, Work work )
+{
+	std::vector< std::thread > threads;
+	for ( int t = 1; t < numThreads; ++t )
+		threads.emplace_back( work, t );
+	work( 0 );
+	for ( std::thread& th : threads )
+		th.join();
+}
+
+
+/// Returns provided number of threads, or number of hardware threads if 0.
+int resolveThreads( int numThreads )
+{
+	return numThreads > 0 ? numThreads 
+			: std::max( 1, (int)std::thread::hardware_concurrency() );
+}
+
+
+/// Same as "floydWarshallShortestPathsWithGlues()", but rows of 'g' are 
+/// split among 'numThreads' threads, which meet at a barrier after every 'k'.
+/// Row 'k' itself is not altered during step 'k' (as "g[k][k] == 0"), so 
+/// it is skipped, and all the threads read it safely. If 'glues' is 
+/// nullptr, only the distances are calculated.
+void floydWarshallShortestPathsParallel( 
+		WeightedAdjacencyMatrix& g, glues_matrix_type* glues = nullptr, 
+		int numThreads = 0 )
+{
+	const int N = g.size();  // Number of vertices
+	numThreads = resolveThreads( numThreads );
+	for ( int i = 0; i < N; ++i ) {
+		g._m[i][i] = 0;
+		if ( glues != nullptr )
+			(*glues)[i][i] = -1;
+	}
+	std::barrier stepDone( numThreads );
+	runOnThreads( numThreads, [&]( int t ) {
+		const int first = (int)( (long long)N * t / numThreads );
+		const int last = (int)( (long long)N * (t+1) / numThreads );
+		for ( int k = 0; k < N; ++k ) {
+			for ( int i = first; i < last; ++i )
+				if ( i != k && g._m[i][k] != WEIGHTED_ADJ_MATRIX_INF )
+					minPlusRow( g._m[i].data(), g._m[k].data(), g._m[i][k], N,
+							glues != nullptr ? (*glues)[i].data() : nullptr, k );
+			stepDone.arrive_and_wait();  // Row 'k+1' must be final
+		}
+	} );
 }
 
 
+/// Same as "floydWarshallShortestPathsBlocked()", but the tiles of every 
+/// phase (the pivot row and column, then the remaining ones) are 
+/// distributed among 'numThreads' threads, with a barrier after each phase.
+void floydWarshallShortestPathsBlockedParallel( DistanceMatrix& d, 
+		int T = FLOYD_WARSHALL_TILE, int numThreads = 0 )
+{
+	const int N = d.size();  // Number of vertices
+	const int B = ( N + T - 1 ) / T;  // Number of tiles in a row
+	numThreads = resolveThreads( numThreads );
+	for ( int i = 0; i < N; ++i )
+		d.at( i, i ) = 0;
+	std::barrier phaseDone( numThreads );
+	runOnThreads( numThreads, [&]( int t ) {
+		for ( int kb = 0; kb < B; ++kb ) {
+			if ( t == 0 )
+				relaxTile( d, kb*T, kb*T, kb*T, T );
+			phaseDone.arrive_and_wait();
+			// Tiles of the pivot row and column: 'b'-th task is "b/2"-th 
+			// tile of the row (when even) or of the column (when odd)
+			for ( int task = t; task < 2*B; task += numThreads ) {
+				const int b = task / 2;
+				if ( b == kb )
+					continue;
+				if ( task % 2 == 0 )
+					relaxTile( d, kb*T, b*T, kb*T, T );
+				else
+					relaxTile( d, b*T, kb*T, kb*T, T );
+			}
+			phaseDone.arrive_and_wait();
+			// All the remaining tiles
+			for ( int task = t; task < B*B; task += numThreads ) {
+				const int ib = task / B, jb = task % B;
+				if ( ib != kb && jb != kb )
+					relaxTile( d, ib*T, jb*T, kb*T, T );
+			}
+			phaseDone.arrive_and_wait();
+		}
+	} );
+}
+
+/// Runs Johnson's all-pair shortest paths algorithm on sparse graph 'g', 
+/// and writes the distances to 'd' (INF where there is no path).
+/// One Bellman-Ford pass from a virtual vertex calculates potentials 'h', 
+/// by which every edge (u,v) is reweighted to "w + h[u] - h[v] >= 0". Then 
+/// Dijkstra's algorithm with an indexed heap runs from every vertex, with
+/// sources split among 'numThreads' threads: O(V E log V) in total.
+/// Returns false (and leaves 'd' untouched) if 'g' has a negative cycle.
+bool johnsonShortestPaths( const WeightedCsrGraph& g, DistanceMatrix& d, 
+		int numThreads = 0 )
+{
+	typedef long long dist_type;  // Reweighted paths may exceed 'int'
+	static const dist_type INF = std::numeric_limits< dist_type >::max();
+	const int N = g.size();  // Number of vertices
+	// Bellman-Ford from a virtual vertex, connected to all by 0 edges
+	std::vector< dist_type > h( N, 0 );
+	bool changed = true;
+	for ( int pass = 0; pass <= N && changed; ++pass ) {
+		changed = false;
+		for ( int u = 0; u < N; ++u ) {
+			const std::span< const int > targets = g.neighbors( u );
+			const std::span< const adj_list_weight_type > weights = g.weights( u );
+			for ( int e = 0; e < (int)targets.size(); ++e )
+				if ( h[ u ] + weights[ e ] < h[ targets[ e ] ] ) {
+					h[ targets[ e ] ] = h[ u ] + weights[ e ];
+					changed = true;
+				}
+		}
+	}
+	if ( changed )
+		return false;  // Still relaxing after N+1 passes: a negative cycle
+	// Reweighted copy of 'g', with no negative edges
+	std::vector< dist_type > weights( g.numEdges() );
+	for ( int u = 0; u < N; ++u )
+		for ( int e = g._offsets[ u ]; e < g._offsets[ u+1 ]; ++e )
+			weights[ e ] = g._weights[ e ] + h[ u ] - h[ g._targets[ e ] ];
+	// Dijkstra's algorithm from every vertex
+	d = DistanceMatrix( N );
+	numThreads = resolveThreads( numThreads );
+	runOnThreads( numThreads, [&]( int t ) {
+		std::vector< dist_type > dist( N, INF );
+		std::vector< int > reached;  // Vertices with finite 'dist'
+		IndexedDaryHeap< dist_type > heap( N );
+		for ( int s = t; s < N; s += numThreads ) {
+			dist[ s ] = 0;
+			reached.push_back( s );
+			heap.pushOrDecrease( s, 0 );
+			while ( ! heap.empty() ) {
+				const int u = heap.pop();
+				for ( int e = g._offsets[ u ]; e < g._offsets[ u+1 ]; ++e ) {
+					const int v = g._targets[ e ];
+					if ( dist[ u ] + weights[ e ] < dist[ v ] ) {
+						if ( dist[ v ] == INF )
+							reached.push_back( v );
+						dist[ v ] = dist[ u ] + weights[ e ];
+						heap.pushOrDecrease( v, dist[ v ] );
+					}
+				}
+			}
+			// Restore the original lengths, and reset only what was touched
+			adj_matrix_weight_type* ds = d.row( s );
+			for ( int v : reached ) {
+				ds[ v ] = (adj_matrix_weight_type)( dist[ v ] - h[ s ] + h[ v ] );
+				dist[ v ] = INF;
+			}
+			reached.clear();
+		}
+	} );
+	return true;
+}
+
 /// Prints all the vertices of shortest path from 's' to 't', 
 /// in exclusive way: (s..t).
 void printPathExclusive( const glues_matrix_type& glues, int s, int t )
@@ -335,8 +634,39 @@ int main( int argc, char* argv[] )
 		h_copy.print();
 	}
 
+	cout << "\t Constructing shortest paths (Johnson's algorithm)..." << endl;
+	{
+		DistanceMatrix d;
+		if ( johnsonShortestPaths( WeightedCsrGraph( h ), d ) ) {
+			WeightedAdjacencyMatrix result;
+			d.copyTo( result );
+			result.print();
+		}
+		else
+			cout << "The graph has a negative cycle." << endl;
+	}
+
+	cout << "\t Constructing shortest paths (CSR graph)..." << endl;
+	{
+		WeightedCsrGraph csr( h );
+		floydWarshallShortestPaths( csr ).print();
+	}
+
+	cout << "\t Constructing shortest paths (blocked, tiles of 3)..." << endl;
+	{
+		DistanceMatrix d( g );
+		floydWarshallShortestPathsBlocked( d, 3 );
+		WeightedAdjacencyMatrix result;
+		d.copyTo( result );
+		result.print();
+	}
+
 	cout << "\t Constructing shortest paths with glues..." << endl;
 	{
+		const char* kernel;
+		selectMinPlusRow( &kernel );
+		cout << "Min-plus kernel in use: " << kernel << endl;
+
 		WeightedAdjacencyMatrix g_copy( g );
 		glues_matrix_type glues( 
 				g_copy.size(), 
@@ -349,6 +679,38 @@ int main( int argc, char* argv[] )
 
 		cout << "Another shortest path is:";
 		printPathInclusive( glues, 'F'-'A', 'E'-'A' );
+
+		const NextHopMatrix next = buildNextHops( g_copy, glues );
+		cout << "Same path, by next hops (" << next.bytesPerEntry() 
+				<< " bytes per entry): [";
+		for ( int v : next.getPath( 'F'-'A', 'E'-'A' ) )
+			cout << " " << char('A'+v);
+		cout << " ]" << endl;
+
+		WeightedAdjacencyMatrix g_hops( g );
+		NextHopMatrix hops;
+		floydWarshallShortestPathsWithNextHops( g_hops, hops );
+		cout << "Same path, by next hops filled while relaxing: [";
+		for ( int v : hops.getPath( 'F'-'A', 'E'-'A' ) )
+			cout << " " << char('A'+v);
+		cout << " ]" << endl;
+		cout << "Same distances: " << ( g_hops._m == g_copy._m ) << endl;
+	}
+
+	cout << "\t Constructing shortest paths with glues, on 4 threads..." << endl;
+	{
+		WeightedAdjacencyMatrix g_copy( g );
+		glues_matrix_type glues( 
+				g_copy.size(), 
+				std::vector<int>( g_copy.size(), -1 ) );
+		floydWarshallShortestPathsParallel( g_copy, &glues, 4 );
+		printGluesMatrix( glues );
+
+		DistanceMatrix d( g );
+		floydWarshallShortestPathsBlockedParallel( d, 3, 4 );
+		WeightedAdjacencyMatrix blocked;
+		d.copyTo( blocked );
+		cout << "Same distances by blocked variant: " << ( blocked._m == g_copy._m ) << endl;
 	}
 
 	return 0;
@@ -0,0 +1,138 @@
+
+#ifndef _INDEXED_DARY_HEAP_HPP
+#define _INDEXED_DARY_HEAP_HPP
+
+#include <vector>
+#include <cassert>
+
+
+/// This class represents a min-heap of vertices "0..N-1", ordered by
+/// their keys, where every node has 'D' children.
+/// Position of every vertex in the heap is remembered, so the key of a
+/// vertex can be decreased in place, and no vertex is ever present in
+/// the heap twice.
+template< typename Key, int D = 4 >
+struct IndexedDaryHeap
+{
+	typedef Key key_type;
+
+	/// The heap itself: vertices, ordered by their keys.
+	std::vector< int > _heap;
+
+	/// "_keys[v]" is the key of vertex 'v', while it is in the heap.
+	std::vector< Key > _keys;
+
+	/// "_pos[v]" is the index of vertex 'v' in '_heap', or -1 if
+	/// 'v' is not in the heap.
+	std::vector< int > _pos;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty heap for vertices "0..N-1".
+	explicit IndexedDaryHeap( int N = 0 )
+		{ reset( N ); }
+
+	/// Makes this heap empty, and ready to hold vertices "0..N-1".
+	void reset( int N )
+		{ _heap.clear();
+		  _keys.resize( N );
+		  _pos.assign( N, -1 ); }
+
+	/// Makes this heap empty, in time proportional to its size, so it is
+	/// ready to hold vertices of the same range again.
+	void clear()
+		{ for ( int v : _heap )
+			  _pos[ v ] = -1;
+		  _heap.clear(); }
+
+	/// Checks if the heap is empty.
+	bool empty() const
+		{ return _heap.empty(); }
+
+	/// Returns number of vertices in the heap.
+	int size() const
+		{ return (int)_heap.size(); }
+
+	/// Checks if vertex 'v' is in the heap.
+	bool contains( int v ) const
+		{ return _pos[ v ] != -1; }
+
+	/// Returns the vertex with minimal key.
+	int top() const
+		{ return _heap.front(); }
+
+	/// Returns key of vertex 'v', which must be in the heap.
+	const Key& key( int v ) const
+		{ return _keys[ v ]; }
+
+	/// Inserts vertex 'v' with key 'k', if it is not in the heap, or
+	/// decreases its key to 'k' otherwise.
+	void pushOrDecrease( int v, const Key& k ) {
+		if ( _pos[ v ] == -1 ) {
+			_pos[ v ] = (int)_heap.size();
+			_heap.push_back( v );
+		}
+		else
+			assert( ! ( _keys[ v ] < k ) );
+		_keys[ v ] = k;
+		siftUp( _pos[ v ] );
+	}
+
+	/// Removes and returns the vertex with minimal key.
+	int pop() {
+		const int v = _heap.front();
+		_pos[ v ] = -1;
+		const int last = _heap.back();
+		_heap.pop_back();
+		if ( ! _heap.empty() ) {
+			_heap.front() = last;
+			_pos[ last ] = 0;
+			siftDown( 0 );
+		}
+		return v;
+	}
+
+protected:
+	/// Moves the vertex at index 'i' towards the root, while its key
+	/// is less than the key of its parent.
+	void siftUp( int i ) {
+		const int v = _heap[ i ];
+		while ( i > 0 ) {
+			const int parent = ( i - 1 ) / D;
+			if ( ! ( _keys[ v ] < _keys[ _heap[ parent ] ] ) )
+				break;
+			_heap[ i ] = _heap[ parent ];
+			_pos[ _heap[ i ] ] = i;
+			i = parent;
+		}
+		_heap[ i ] = v;
+		_pos[ v ] = i;
+	}
+
+	/// Moves the vertex at index 'i' towards the leaves, while it has
+	/// a child with smaller key.
+	void siftDown( int i ) {
+		const int n = (int)_heap.size();
+		const int v = _heap[ i ];
+		while ( true ) {
+			const int first = i * D + 1;  // First child of 'i'
+			if ( first >= n )
+				break;
+			const int last = first + D < n ? first + D : n;
+			int best = first;  // Child with minimal key
+			for ( int c = first + 1; c < last; ++c )
+				if ( _keys[ _heap[ c ] ] < _keys[ _heap[ best ] ] )
+					best = c;
+			if ( ! ( _keys[ _heap[ best ] ] < _keys[ v ] ) )
+				break;
+			_heap[ i ] = _heap[ best ];
+			_pos[ _heap[ i ] ] = i;
+			i = best;
+		}
+		_heap[ i ] = v;
+		_pos[ v ] = i;
+	}
+};
+
+
+#endif // _INDEXED_DARY_HEAP_HPP
@@ -0,0 +1,244 @@
+
+#ifndef _MIN_PLUS_KERNELS_HPP
+#define _MIN_PLUS_KERNELS_HPP
+
+#include <cstdint>
+
+#include "WeightedAdjacencyMatrix.hpp"
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && ( defined(__GNUC__) || defined(__clang__) )
+#define MIN_PLUS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+/// The min-plus kernels relax one row of distances 'di' (of length 'n')
+/// through the vertex 'k', i.e. for every 'j':
+///    if ( dk[j] != INF && dik + dk[j] < di[j] ) {
+///        di[j] = dik + dk[j];
+///        gi[j] = k;   // Only if glues row 'gi' is provided
+///    }
+/// where 'dk' is the row of 'k', and 'dik' is the (finite) distance from
+/// 'i' to 'k'. An infinite "dk[j]" is masked out, instead of being
+/// saturated by addition, so negative weights are handled properly too.
+/// Neither of the kernels has branches in its loop.
+typedef void (*min_plus_row_type)(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, int* gi, int k );
+
+
+/// Portable min-plus kernel, used when no vector extensions are available.
+inline void minPlusRowScalar(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, int* gi, int k )
+{
+	for ( int j = 0; j < n; ++j ) {
+		const adj_matrix_weight_type through = dik + dk[ j ];
+		const bool better = dk[ j ] != WEIGHTED_ADJ_MATRIX_INF && through < di[ j ];
+		di[ j ] = better ? through : di[ j ];
+		if ( gi != nullptr )
+			gi[ j ] = better ? k : gi[ j ];
+	}
+}
+
+
+/// The next-hop kernels relax a row the same way, but instead of 'k' they
+/// store 'hop' into 16-bit entries 'ni' of the row 'i' of a next-hop
+/// matrix, where 'hop' is the next hop from 'i' towards 'k': a path via
+/// 'k' starts by the same edge, as the path to 'k'.
+typedef void (*min_plus_hops_row_type)(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint16_t* ni, std::uint16_t hop );
+
+
+/// Portable next-hop kernel.
+inline void minPlusHopsRowScalar(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint16_t* ni, std::uint16_t hop )
+{
+	for ( int j = 0; j < n; ++j ) {
+		const adj_matrix_weight_type through = dik + dk[ j ];
+		const bool better = dk[ j ] != WEIGHTED_ADJ_MATRIX_INF && through < di[ j ];
+		di[ j ] = better ? through : di[ j ];
+		ni[ j ] = better ? hop : ni[ j ];
+	}
+}
+
+
+#ifdef MIN_PLUS_X86_KERNELS
+
+static_assert( sizeof( adj_matrix_weight_type ) == 4,
+		"The vector kernels process weights as 32-bit integers" );
+
+/// Min-plus kernel over 8 distances at a time, with AVX2 blends.
+__attribute__(( target( "avx2" ) ))
+inline void minPlusRowAvx2(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, int* gi, int k )
+{
+	const __m256i inf = _mm256_set1_epi32( WEIGHTED_ADJ_MATRIX_INF );
+	const __m256i vik = _mm256_set1_epi32( dik );
+	const __m256i vk = _mm256_set1_epi32( k );
+	int j = 0;
+	for ( ; j + 8 <= n; j += 8 ) {
+		const __m256i dkj = _mm256_loadu_si256( (const __m256i*)( dk + j ) );
+		const __m256i dij = _mm256_loadu_si256( (const __m256i*)( di + j ) );
+		const __m256i through = _mm256_add_epi32( vik, dkj );
+		const __m256i better = _mm256_andnot_si256(
+				_mm256_cmpeq_epi32( dkj, inf ),
+				_mm256_cmpgt_epi32( dij, through ) );
+		_mm256_storeu_si256( (__m256i*)( di + j ),
+				_mm256_blendv_epi8( dij, through, better ) );
+		if ( gi != nullptr ) {
+			const __m256i gij = _mm256_loadu_si256( (const __m256i*)( gi + j ) );
+			_mm256_storeu_si256( (__m256i*)( gi + j ),
+					_mm256_blendv_epi8( gij, vk, better ) );
+		}
+	}
+	minPlusRowScalar( di + j, dk + j, dik, n - j, gi != nullptr ? gi + j : nullptr, k );
+}
+
+
+/// Same as above, storing 'hop' to 16-bit next hops 'ni' (see the
+/// next-hop kernels below): the mask of 8 distances is packed to 16 bits.
+__attribute__(( target( "avx2" ) ))
+inline void minPlusHopsRowAvx2(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint16_t* ni, std::uint16_t hop )
+{
+	const __m256i inf = _mm256_set1_epi32( WEIGHTED_ADJ_MATRIX_INF );
+	const __m256i vik = _mm256_set1_epi32( dik );
+	const __m128i vhop = _mm_set1_epi16( (short)hop );
+	int j = 0;
+	for ( ; j + 8 <= n; j += 8 ) {
+		const __m256i dkj = _mm256_loadu_si256( (const __m256i*)( dk + j ) );
+		const __m256i dij = _mm256_loadu_si256( (const __m256i*)( di + j ) );
+		const __m256i through = _mm256_add_epi32( vik, dkj );
+		const __m256i better = _mm256_andnot_si256(
+				_mm256_cmpeq_epi32( dkj, inf ),
+				_mm256_cmpgt_epi32( dij, through ) );
+		_mm256_storeu_si256( (__m256i*)( di + j ),
+				_mm256_blendv_epi8( dij, through, better ) );
+		const __m128i better16 = _mm_packs_epi32(
+				_mm256_castsi256_si128( better ), _mm256_extracti128_si256( better, 1 ) );
+		const __m128i nij = _mm_loadu_si128( (const __m128i*)( ni + j ) );
+		_mm_storeu_si128( (__m128i*)( ni + j ), _mm_blendv_epi8( nij, vhop, better16 ) );
+	}
+	minPlusHopsRowScalar( di + j, dk + j, dik, n - j, ni + j, hop );
+}
+
+
+/// Min-plus kernel over 16 distances at a time, with AVX-512 masked stores.
+__attribute__(( target( "avx512f" ) ))
+inline void minPlusRowAvx512(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, int* gi, int k )
+{
+	const __m512i inf = _mm512_set1_epi32( WEIGHTED_ADJ_MATRIX_INF );
+	const __m512i vik = _mm512_set1_epi32( dik );
+	const __m512i vk = _mm512_set1_epi32( k );
+	int j = 0;
+	for ( ; j + 16 <= n; j += 16 ) {
+		const __m512i dkj = _mm512_loadu_si512( dk + j );
+		const __m512i dij = _mm512_loadu_si512( di + j );
+		const __m512i through = _mm512_add_epi32( vik, dkj );
+		const __mmask16 better = _mm512_mask_cmpgt_epi32_mask(
+				_mm512_cmpneq_epi32_mask( dkj, inf ), dij, through );
+		_mm512_mask_storeu_epi32( di + j, better, through );
+		if ( gi != nullptr )
+			_mm512_mask_storeu_epi32( gi + j, better, vk );
+	}
+	minPlusRowScalar( di + j, dk + j, dik, n - j, gi != nullptr ? gi + j : nullptr, k );
+}
+
+
+/// Same as above, storing 'hop' to 16-bit next hops 'ni'. AVX-512F has no
+/// masked 16-bit stores, so the hops are widened, blended and narrowed.
+__attribute__(( target( "avx512f" ) ))
+inline void minPlusHopsRowAvx512(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint16_t* ni, std::uint16_t hop )
+{
+	const __m512i inf = _mm512_set1_epi32( WEIGHTED_ADJ_MATRIX_INF );
+	const __m512i vik = _mm512_set1_epi32( dik );
+	const __m512i vhop = _mm512_set1_epi32( hop );
+	int j = 0;
+	for ( ; j + 16 <= n; j += 16 ) {
+		const __m512i dkj = _mm512_loadu_si512( dk + j );
+		const __m512i dij = _mm512_loadu_si512( di + j );
+		const __m512i through = _mm512_add_epi32( vik, dkj );
+		const __mmask16 better = _mm512_mask_cmpgt_epi32_mask(
+				_mm512_cmpneq_epi32_mask( dkj, inf ), dij, through );
+		_mm512_mask_storeu_epi32( di + j, better, through );
+		const __m512i nij = _mm512_cvtepu16_epi32(
+				_mm256_loadu_si256( (const __m256i*)( ni + j ) ) );
+		_mm256_storeu_si256( (__m256i*)( ni + j ),
+				_mm512_cvtepi32_epi16( _mm512_mask_mov_epi32( nij, better, vhop ) ) );
+	}
+	minPlusHopsRowScalar( di + j, dk + j, dik, n - j, ni + j, hop );
+}
+
+#endif // MIN_PLUS_X86_KERNELS
+
+
+/// Returns the widest min-plus kernel, supported by this CPU.
+/// If 'name' is provided, stores there the name of the kernel.
+inline min_plus_row_type selectMinPlusRow( const char** name = nullptr )
+{
+	const char* dummy;
+	const char*& selected = name != nullptr ? *name : dummy;
+#ifdef MIN_PLUS_X86_KERNELS
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx512f" ) )
+		{ selected = "AVX-512"; return minPlusRowAvx512; }
+	if ( __builtin_cpu_supports( "avx2" ) )
+		{ selected = "AVX2"; return minPlusRowAvx2; }
+#endif
+	selected = "scalar";
+	return minPlusRowScalar;
+}
+
+
+/// Relaxes one row of distances through vertex 'k', by the widest
+/// kernel, which is supported by this CPU. It is detected at first call.
+inline void minPlusRow(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, int* gi = nullptr, int k = 0 )
+{
+	static const min_plus_row_type kernel = selectMinPlusRow();
+	kernel( di, dk, dik, n, gi, k );
+}
+
+
+/// Returns the widest next-hop kernel, supported by this CPU.
+inline min_plus_hops_row_type selectMinPlusHopsRow()
+{
+#ifdef MIN_PLUS_X86_KERNELS
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx512f" ) )
+		return minPlusHopsRowAvx512;
+	if ( __builtin_cpu_supports( "avx2" ) )
+		return minPlusHopsRowAvx2;
+#endif
+	return minPlusHopsRowScalar;
+}
+
+
+/// Relaxes one row of distances through vertex 'k', and stores 'hop' to
+/// the next hops 'ni' of the improved distances, by the widest kernel.
+/// 32-bit next hops are stored by the glues blend of "minPlusRow()", as
+/// they have the same layout as 'int'-s.
+inline void minPlusRow(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint16_t* ni, std::uint16_t hop )
+{
+	static const min_plus_hops_row_type kernel = selectMinPlusHopsRow();
+	kernel( di, dk, dik, n, ni, hop );
+}
+inline void minPlusRow(
+		adj_matrix_weight_type* di, const adj_matrix_weight_type* dk,
+		adj_matrix_weight_type dik, int n, std::uint32_t* ni, std::uint32_t hop )
+	{ minPlusRow( di, dk, dik, n, reinterpret_cast< int* >( ni ), (int)hop ); }
+
+
+#endif // _MIN_PLUS_KERNELS_HPP
@@ -0,0 +1,120 @@
+
+#ifndef _NEXT_HOP_MATRIX_HPP
+#define _NEXT_HOP_MATRIX_HPP
+
+#include <vector>
+#include <variant>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+
+/// This class represents the next-hop matrix of all-pair shortest paths:
+/// "next(i,j)" is the vertex, which follows 'i' on a shortest path from
+/// 'i' to 'j'. So a path is restored by a forward walk of its length,
+/// with no recursion.
+/// The matrix is stored contiguously, with 16-bit entries when there are
+/// less than 65535 vertices (half the memory of an 'int' glues matrix),
+/// and with 32-bit entries otherwise.
+struct NextHopMatrix
+{
+	typedef std::vector< std::uint16_t > narrow_type;
+	typedef std::vector< std::uint32_t > wide_type;
+
+	/// Number of vertices.
+	int _n;
+
+	/// The entries: "_next[ i*_n + j ]" is the next hop from 'i' towards 'j',
+	/// or the maximal value of the entry type, if there is no path.
+	std::variant< narrow_type, wide_type > _next;
+
+public:
+	/// [Default] constructor
+	/// Creates 'N*N' matrix, where no vertex has a path to another one.
+	explicit NextHopMatrix( int N = 0 )
+		: _n( N ) {
+		const std::size_t entries = (std::size_t)N * N;
+		if ( N < std::numeric_limits< std::uint16_t >::max() )
+			_next = narrow_type( entries, std::numeric_limits< std::uint16_t >::max() );
+		else
+			_next = wide_type( entries, std::numeric_limits< std::uint32_t >::max() );
+	}
+
+	/// Number of vertices.
+	int size() const
+		{ return _n; }
+
+	/// Number of bytes, occupied by one entry.
+	int bytesPerEntry() const
+		{ return _next.index() == 0 ? 2 : 4; }
+
+	/// Returns the next hop from 'i' towards 'j', or -1 if there is no path.
+	int next( int i, int j ) const {
+		return std::visit( [&]( const auto& entries ) {
+			typedef typename std::decay_t< decltype( entries ) >::value_type entry_type;
+			const entry_type e = entries[ (std::size_t)i * _n + j ];
+			return e == std::numeric_limits< entry_type >::max() ? -1 : (int)e;
+		}, _next );
+	}
+
+	/// Sets the next hop from 'i' towards 'j' to be 'v' (-1 for no path).
+	void setNext( int i, int j, int v ) {
+		std::visit( [&]( auto& entries ) {
+			typedef typename std::decay_t< decltype( entries ) >::value_type entry_type;
+			entries[ (std::size_t)i * _n + j ] =
+					v == -1 ? std::numeric_limits< entry_type >::max() : (entry_type)v;
+		}, _next );
+	}
+
+	/// Calls "f(entries)" with the vector of all the entries, where
+	/// "entries[ i*N + j ]" is the next hop from 'i' towards 'j', and no
+	/// path is marked by the maximal value of the entry type. So algorithms
+	/// fill the matrix by loops over entries of the actual type.
+	template< typename Function >
+	void visitEntries( Function f )
+		{ std::visit( f, _next ); }
+
+	/// Calls 'f(v)' for all the vertices 'v' of shortest path from 's' to
+	/// 't', in inclusive way [s..t]. Returns false if there is no path.
+	template< typename Function >
+	bool forEachOnPath( int s, int t, Function f ) const {
+		return std::visit( [&]( const auto& entries ) {
+			typedef typename std::decay_t< decltype( entries ) >::value_type entry_type;
+			const entry_type NONE = std::numeric_limits< entry_type >::max();
+			if ( s != t && entries[ (std::size_t)s * _n + t ] == NONE )
+				return false;
+			int at = s;
+			f( at );
+			while ( at != t ) {
+				at = entries[ (std::size_t)at * _n + t ];
+				f( at );
+			}
+			return true;
+		}, _next );
+	}
+
+	/// Writes all the vertices of shortest path from 's' to 't', in inclusive
+	/// way [s..t], to the buffer 'path' of size 'capacity'.
+	/// Returns number of vertices in the path (which might be greater than
+	/// 'capacity', then only its prefix is written), or 0 if there is no path.
+	int getPath( int s, int t, int* path, int capacity ) const {
+		int length = 0;
+		forEachOnPath( s, t, [&]( int v ) {
+			if ( length < capacity )
+				path[ length ] = v;
+			++length;
+		} );
+		return length;
+	}
+
+	/// Returns all the vertices of shortest path from 's' to 't', in inclusive
+	/// way [s..t], or empty path if 't' is not reachable from 's'.
+	std::vector< int > getPath( int s, int t ) const {
+		std::vector< int > path;
+		forEachOnPath( s, t, [&]( int v ) { path.push_back( v ); } );
+		return path;
+	}
+};
+
+
+#endif // _NEXT_HOP_MATRIX_HPP
@@ -0,0 +1,95 @@
+
+#ifndef _CSR_GRAPH_HPP
+#define _CSR_GRAPH_HPP
+
+#include <vector>
+#include <span>
+#include <algorithm>
+
+#include "AdjacencyList.hpp"
+
+
+/// This class represents a frozen (not modifiable) unweighted graph in
+/// compressed sparse row form.
+/// Targets of all the edges, which start at vertex 'u', are stored
+/// contiguously in "_targets[ _offsets[u] .. _offsets[u+1] )", so
+/// visiting neighbors of a vertex is a linear scan of memory.
+struct CsrGraph
+{
+	typedef std::vector< int > offsets_type;
+	typedef std::vector< int > targets_type;
+
+	/// "_offsets[u]" is the index in '_targets' of the first edge of 'u'.
+	/// Has "N+1" elements, the last one equals to number of edges.
+	offsets_type _offsets;
+
+	/// Targets of all the edges, grouped by their source vertex.
+	targets_type _targets;
+
+public:
+	/// [Default] constructor
+	/// Creates an empty graph.
+	CsrGraph()
+		: _offsets( 1, 0 )
+		{}
+
+	/// Constructor
+	/// Freezes provided adjacency list 'g'. Order of neighbors of every
+	/// vertex is preserved, so traversals visit vertices in same order.
+	explicit CsrGraph( const AdjacencyList& g )
+		: _offsets( g.size() + 1, 0 ) {
+		const int N = g.size();  // Number of vertices
+		for ( int u = 0; u < N; ++u )
+			_offsets[ u+1 ] = _offsets[ u ] + (int)g._adj[ u ].size();
+		_targets.reserve( _offsets[ N ] );
+		for ( int u = 0; u < N; ++u )
+			_targets.insert( _targets.end(), g._adj[ u ].cbegin(), g._adj[ u ].cend() );
+	}
+
+	/// Returns number of vertices in this graph.
+	int size() const
+		{ return (int)_offsets.size() - 1; }
+
+	/// Returns number of edges in this graph.
+	int numEdges() const
+		{ return (int)_targets.size(); }
+
+	/// Returns number of edges, which start at vertex 'u'.
+	int degree( int u ) const
+		{ return _offsets[ u+1 ] - _offsets[ u ]; }
+
+	/// Returns all vertices 'v', for which edge "(u,v)" is present.
+	std::span< const int > neighbors( int u ) const
+		{ return std::span< const int >(
+				_targets.data() + _offsets[ u ],
+				_targets.data() + _offsets[ u+1 ] ); }
+
+	/// Checks if the graph has edge "(u,v)".
+	bool hasEdge( int u, int v ) const
+		{ const std::span< const int > adj = neighbors( u );
+		  return std::find( adj.begin(), adj.end(), v ) != adj.end(); }
+	bool hasEdge( char u, char v ) const
+		{ return hasEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+	/// Returns the transposed graph, where every edge has opposite
+	/// direction. Works in O(V+E), by counting sort of edges by target, so
+	/// neighbors of every vertex of the result are ordered by their index.
+	CsrGraph transposed() const {
+		const int N = size();  // Number of vertices
+		CsrGraph result;
+		result._offsets.assign( N + 1, 0 );
+		for ( int v : _targets )
+			++result._offsets[ v+1 ];
+		for ( int v = 0; v < N; ++v )
+			result._offsets[ v+1 ] += result._offsets[ v ];
+		result._targets.resize( _targets.size() );
+		offsets_type pos( result._offsets.cbegin(), result._offsets.cend() - 1 );
+		for ( int u = 0; u < N; ++u )
+			for ( int v : neighbors( u ) )
+				result._targets[ pos[ v ]++ ] = u;
+		return result;
+	}
+};
+
+
+#endif // _CSR_GRAPH_HPP
@@ -0,0 +1,154 @@
+
+#ifndef _INCREMENTAL_TOPOLOGICAL_ORDER_HPP
+#define _INCREMENTAL_TOPOLOGICAL_ORDER_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "AdjacencyList.hpp"
+
+
+/// This class represents a directed acyclic graph together with its
+/// topological order, which is maintained while edges are being added
+/// (algorithm of Pearce and Kelly).
+/// Adding edge "(u,v)", where 'u' already precedes 'v', costs only the
+/// insertion. Otherwise only the vertices with positions between 'v' and
+/// 'u', which are reachable from 'v' or reach 'u', are reordered.
+/// An edge which would create a cycle is rejected.
+struct IncrementalTopologicalOrder
+{
+	/// The outgoing edges of the graph.
+	AdjacencyList _out;
+
+	/// The incoming edges of the graph: "_in._adj[v]" contains all 'u',
+	/// for which edge "(u,v)" is present.
+	AdjacencyList _in;
+
+	/// "_order[i]" is the vertex at position 'i' of the topological order.
+	std::vector< int > _order;
+
+	/// "_pos[v]" is the position of vertex 'v' in '_order'.
+	std::vector< int > _pos;
+
+	/// Marks of the vertices, visited while searching for the affected region.
+	std::vector< char > _visited;
+
+	/// The affected vertices: reachable from 'v' and reaching 'u'.
+	std::vector< int > _forward, _backward;
+
+	/// The stack of vertices to visit.
+	std::vector< int > _stack;
+
+public:
+	/// [Default] constructor
+	/// Creates a graph with 'N' vertices and no edges, ordered as "0..N-1".
+	explicit IncrementalTopologicalOrder( int N = 0 )
+		: _out( N ),
+		  _in( N ),
+		  _order( N ),
+		  _pos( N ),
+		  _visited( N, false ) {
+		_out.setIndexed( true );
+		for ( int v = 0; v < N; ++v )
+			_order[ v ] = _pos[ v ] = v;
+	}
+
+	/// Returns number of vertices in the graph.
+	int size() const
+		{ return (int)_order.size(); }
+
+	/// Returns the graph (its outgoing edges).
+	const AdjacencyList& graph() const
+		{ return _out; }
+
+	/// Returns current topological order of all the vertices.
+	const std::vector< int >& order() const
+		{ return _order; }
+
+	/// Returns position of vertex 'v' in the current topological order.
+	int position( int v ) const
+		{ return _pos[ v ]; }
+
+	/// Adds edge "(u,v)" to the graph, in case if it was not present, and
+	/// reorders vertices if necessary.
+	/// Returns false (leaving the graph and the order unchanged) if the edge
+	/// would create a cycle.
+	bool addEdge( int u, int v ) {
+		if ( u == v )
+			return false;
+		if ( _out.hasEdge( u, v ) )
+			return true;
+		if ( _pos[ u ] > _pos[ v ] ) {
+			// Discover the affected region
+			if ( ! search( v, _out, _pos[ u ], true, _forward ) ) {
+				unmark( _forward );
+				return false;  // 'u' is reachable from 'v'
+			}
+			search( u, _in, _pos[ v ], false, _backward );
+			reorder();
+		}
+		_out.addEdge( u, v );
+		_in._adj[ v ].push_back( u );
+		return true;
+	}
+	bool addEdge( char u, char v )
+		{ return addEdge( (int)(u-'A'), (int)(v-'A') ); }
+
+protected:
+	/// Collects into 'visited' all the vertices reachable from 's' by edges
+	/// of 'g', which have position not after 'bound' (if 'forward'), or not
+	/// before it (otherwise). Returns false, if the vertex at position
+	/// 'bound' is reached while going forward, meaning a cycle.
+	bool search( int s, const AdjacencyList& g, int bound, bool forward,
+			std::vector< int >& visited ) {
+		visited.assign( 1, s );
+		_stack.assign( 1, s );
+		_visited[ s ] = true;
+		while ( ! _stack.empty() ) {
+			const int w = _stack.back();
+			_stack.pop_back();
+			for ( int x : g.neighbors( w ) ) {
+				if ( forward && _pos[ x ] == bound )
+					return false;
+				if ( ! _visited[ x ] && ( forward ? _pos[ x ] < bound : _pos[ x ] > bound ) ) {
+					_visited[ x ] = true;
+					visited.push_back( x );
+					_stack.push_back( x );
+				}
+			}
+		}
+		return true;
+	}
+
+	/// Clears visited marks of the vertices 'vs'.
+	void unmark( const std::vector< int >& vs ) {
+		for ( int w : vs )
+			_visited[ w ] = false;
+	}
+
+	/// Places all the '_backward' vertices before all the '_forward' ones,
+	/// keeping their relative order, on the positions which they occupied.
+	void reorder() {
+		auto byPosition = [this]( int a, int b ) { return _pos[ a ] < _pos[ b ]; };
+		std::sort( _forward.begin(), _forward.end(), byPosition );
+		std::sort( _backward.begin(), _backward.end(), byPosition );
+		// Vertices in their new order
+		_stack.assign( _backward.cbegin(), _backward.cend() );
+		_stack.insert( _stack.end(), _forward.cbegin(), _forward.cend() );
+		// The positions, which they occupy
+		std::vector< int > positions;
+		positions.reserve( _stack.size() );
+		for ( int w : _stack )
+			positions.push_back( _pos[ w ] );
+		std::sort( positions.begin(), positions.end() );
+		for ( int i = 0; i < (int)_stack.size(); ++i ) {
+			_order[ positions[ i ] ] = _stack[ i ];
+			_pos[ _stack[ i ] ] = positions[ i ];
+		}
+		unmark( _forward );
+		unmark( _backward );
+	}
+};
+
+
+#endif // _INCREMENTAL_TOPOLOGICAL_ORDER_HPP
@@ -42,8 +42,14 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <barrier>
 
 #include "AdjacencyList.hpp"
+#include "CsrGraph.hpp"
+#include "IncrementalTopologicalOrder.hpp"
 
 
 /// Given an unweighted graph 'g', checks if the order of
@@ -80,10 +86,47 @@ bool isTopologicallySorted(
 }
 
 
+/// Extracts one cycle of graph 'g', among the vertices 'remaining', which
+/// were left by Kahn's algorithm (i.e. every one of them has an incoming
+/// edge from another remaining vertex). Runs in linear time: remembers one
+/// remaining predecessor of every remaining vertex, and walks over the
+/// predecessors until some vertex repeats.
+/// Returns vertices of the cycle in order of its edges.
+template< typename Graph >
+std::vector< int > extractCycle(
+		const Graph& g, const std::vector< int >& remaining )
+{
+	const int N = g.size();  // Number of vertices
+	std::vector< char > isRemaining( N, false );
+	for ( int v : remaining )
+		isRemaining[ v ] = true;
+	std::vector< int > predecessor( N, -1 );
+	for ( int u : remaining )
+		for ( int v : g.neighbors( u ) )
+			if ( isRemaining[ v ] )
+				predecessor[ v ] = u;
+	std::vector< int > cycle;
+	if ( remaining.empty() )
+		return cycle;
+	// Walk backwards, until a vertex is met for the second time
+	std::vector< char > isMet( N, false );
+	int v = remaining.front();
+	for ( ; ! isMet[ v ]; v = predecessor[ v ] )
+		isMet[ v ] = true;
+	for ( int u = v; cycle.empty() || u != v; u = predecessor[ u ] )
+		cycle.push_back( u );
+	std::reverse( cycle.begin(), cycle.end() );
+	return cycle;
+}
+
+
 /// Performs Kahn's algorithm on provided graph 'g', by sequentially
 /// removing edges and vertices from it.
-/// In case if there is a cycle, returns empty sequence.
-std::vector<int> topologicalSort(AdjacencyList g) {
+/// In case if there is a cycle, returns empty sequence, while 'remaining'
+/// receives all the vertices which were not removed, and 'cycle' receives
+/// one cycle among them.
+std::vector<int> topologicalSort(AdjacencyList g,
+        std::vector<int>& remaining, std::vector<int>& cycle) {
     const int N = g.size(); // Number of vertices
     std::vector<int> result;
     std::vector<bool> isRemoved(N, false); // If vertex 'i' was removed
@@ -99,8 +142,14 @@ std::vector<int> topologicalSort(AdjacencyList g) {
         for (u = 0; u < N; ++u)
             if (!isRemoved[u] && !hasIncoming[u])
                 break; // Found 'u'
-        if (u == -1) // If no such vertex was found
+        if (u == N) { // If no such vertex was found
+            remaining.clear();
+            for (int v = 0; v < N; ++v)
+                if (!isRemoved[v])
+                    remaining.push_back(v);
+            cycle = extractCycle(g, remaining);
             return std::vector<int>(); // Empty result means there is a cycle
+        }
         // Now the vertex 'u' has no incoming edges:
         //    ... place it into result,
         result.push_back(u);
@@ -108,10 +157,17 @@ std::vector<int> topologicalSort(AdjacencyList g) {
         g._adj[u].clear(); // Removing all edges which start at 'u'.
         isRemoved[u] = true;
     }
+    remaining.clear();
+    cycle.clear();
     return result;
 }
+std::vector<int> topologicalSort(AdjacencyList g) {
+    std::vector<int> remaining, cycle;
+    return topologicalSort(std::move(g), remaining, cycle);
+}
+/// Same as "topologicalSort()", but keeps incoming degrees of the vertices.
 std::vector< int > topologicalSort_degree
-( AdjacencyList g )
+( AdjacencyList g, std::vector< int >& remaining, std::vector< int >& cycle )
 {
 	const int N = g.size();
 	std::vector<int> degree(N, 0);
@@ -128,23 +184,44 @@ std::vector< int > topologicalSort_degree
 				u = i;
 				break;
 			}
-		if (u == -1)
+		if (u == -1) {
+			remaining.clear();
+			for (int i = 0; i < N; ++i)
+				if (!removed[i])
+					remaining.push_back(i);
+			cycle = extractCycle(g, remaining);
 			return std::vector<int>();
+		}
 		result.push_back(u);
 		for (int v : g._adj[u])
 			--degree[v];
 		removed[u] = true;
 	}
+	remaining.clear();
+	cycle.clear();
 	return result;
 }
+std::vector< int > topologicalSort_degree( AdjacencyList g )
+{
+	std::vector< int > remaining, cycle;
+	return topologicalSort_degree( std::move( g ), remaining, cycle );
+}
 #include <queue>
 
-std::vector< int > topologicalSort_queue( const AdjacencyList& g )
+/// Performs Kahn's algorithm on graph 'g', keeping the vertices with no
+/// incoming edges in a queue. 'g' can be any representation providing
+/// "size()" and "neighbors(u)", e.g. AdjacencyList or CsrGraph.
+/// In case if there is a cycle, returns empty sequence, while 'remaining'
+/// receives all the vertices left with nonzero incoming degree, and
+/// 'cycle' receives one cycle among them.
+template< typename Graph >
+std::vector< int > topologicalSort_queue( const Graph& g,
+		std::vector< int >& remaining, std::vector< int >& cycle )
 {
 	const int N = g.size();
 	std::vector<int> degree(N, 0);
 	for (int u = 0; u < N; ++u)
-		for (int v : g._adj[u])
+		for (int v : g.neighbors(u))
 			++degree[v];
 
 	std::queue<int> q;
@@ -156,18 +233,39 @@ std::vector< int > topologicalSort_queue( const AdjacencyList& g )
 	while (!q.empty()) {
 		int u = q.front(); q.pop();
 		result.push_back(u);
-		for (int v : g._adj[u])
+		for (int v : g.neighbors(u))
 			if (--degree[v] == 0)
 				q.push(v);
 	}
-	return (result.size() == N) ? result : std::vector<int>();
+	remaining.clear();
+	cycle.clear();
+	if ((int)result.size() == N)
+		return result;
+	for (int i = 0; i < N; ++i)
+		if (degree[i] != 0)
+			remaining.push_back(i);
+	cycle = extractCycle(g, remaining);
+	return std::vector<int>();
 }
-std::vector<int> topologicalSortIncoming(const AdjacencyList& incoming)
+template< typename Graph >
+std::vector< int > topologicalSort_queue( const Graph& g )
 {
-	int N = incoming.size();
+	std::vector< int > remaining, cycle;
+	return topologicalSort_queue( g, remaining, cycle );
+}
+/// Performs Kahn's algorithm on graph, which is given by its incoming
+/// edges: "incoming.neighbors(v)" are all the vertices 'u', for which edge
+/// "(u,v)" is present. Incoming degrees are read directly, while outgoing
+/// edges are obtained by transposing 'incoming' in O(V+E), so the whole
+/// sort is linear.
+/// In case if there is a cycle, returns empty sequence.
+std::vector<int> topologicalSortIncoming(const CsrGraph& incoming)
+{
+	const int N = incoming.size();
+	const CsrGraph outgoing = incoming.transposed();
 	std::vector<int> degree(N, 0);
 	for (int u = 0; u < N; ++u)
-		degree[u] = incoming._adj[u].size();
+		degree[u] = incoming.degree(u);
 
 	std::queue<int> q;
 	for (int i = 0; i < N; ++i)
@@ -178,15 +276,92 @@ std::vector<int> topologicalSortIncoming(const AdjacencyList& incoming)
 	while (!q.empty()) {
 		int u = q.front(); q.pop();
 		result.push_back(u);
-		for (int v = 0; v < N; ++v)
-			for (int src : incoming._adj[v])
-				if (src == u && --degree[v] == 0)
-					q.push(v);
+		for (int v : outgoing.neighbors(u))
+			if (--degree[v] == 0)
+				q.push(v);
 	}
-	return (result.size() == N) ? result : std::vector<int>();
+	return ((int)result.size() == N) ? result : std::vector<int>();
+}
+std::vector<int> topologicalSortIncoming(const AdjacencyList& incoming)
+{
+	return topologicalSortIncoming(CsrGraph(incoming));
 }
 
 
+/// Performs Kahn's algorithm on graph 'g' wave by wave, on 'numThreads'
+/// threads (0 means all the hardware threads): every wave consists of the
+/// vertices, all incoming edges of which come from the previous waves.
+/// Vertices of one wave are processed concurrently, and incoming degrees
+/// of their successors are decremented atomically, so the thread which
+/// brings a degree to 0 places that vertex into the next wave.
+/// Fills 'levels' with wave index of every vertex, which is also the length
+/// of the longest path ending at it, so vertices with the same level can
+/// be scheduled in parallel. Order of vertices within one wave is not
+/// specified. In case if there is a cycle, returns empty sequence, and
+/// vertices which are not ordered have level -1.
+template< typename Graph >
+std::vector< int > topologicalSort_parallel(
+		const Graph& g, std::vector< int >& levels, int numThreads = 0 )
+{
+	const int N = g.size();  // Number of vertices
+	if ( numThreads <= 0 )
+		numThreads = std::max( 1, (int)std::thread::hardware_concurrency() );
+	levels.assign( N, -1 );
+	std::vector< std::atomic< int > > degree( N );
+	for ( std::atomic< int >& d : degree )
+		d.store( 0, std::memory_order_relaxed );
+	std::vector< int > result;
+	result.reserve( N );
+	std::vector< int > wave;  // Vertices of the current wave
+	std::vector< std::vector< int > > localNext( numThreads );
+	// Merges local next waves in the order of threads, when all of them
+	// finished the current wave
+	auto onWaveEnd = [&]() noexcept {
+		wave.clear();
+		for ( std::vector< int >& local : localNext ) {
+			wave.insert( wave.end(), local.cbegin(), local.cend() );
+			local.clear();
+		}
+		result.insert( result.end(), wave.cbegin(), wave.cend() );
+	};
+	std::barrier counted( numThreads );
+	std::barrier waveEnd( numThreads, onWaveEnd );
+	auto worker = [&]( int t ) {
+		const int first = (int)( (long long)N * t / numThreads );
+		const int last = (int)( (long long)N * (t+1) / numThreads );
+		// Count incoming degrees, from edges of our range of vertices
+		for ( int u = first; u < last; ++u )
+			for ( int v : g.neighbors( u ) )
+				degree[ v ].fetch_add( 1, std::memory_order_relaxed );
+		counted.arrive_and_wait();
+		// Vertices of our range with no incoming edges form the first wave
+		std::vector< int >& next = localNext[ t ];
+		for ( int u = first; u < last; ++u )
+			if ( degree[ u ].load( std::memory_order_relaxed ) == 0 ) {
+				next.push_back( u );
+				levels[ u ] = 0;
+			}
+		waveEnd.arrive_and_wait();
+		for ( int level = 1; ! wave.empty(); ++level ) {
+			const int W = (int)wave.size();
+			for ( int i = (int)( (long long)W * t / numThreads ),
+					end = (int)( (long long)W * (t+1) / numThreads ); i < end; ++i )
+				for ( int v : g.neighbors( wave[ i ] ) )
+					if ( degree[ v ].fetch_sub( 1, std::memory_order_relaxed ) == 1 ) {
+						next.push_back( v );  // The last incoming edge is removed
+						levels[ v ] = level;
+					}
+			waveEnd.arrive_and_wait();
+		}
+	};
+	std::vector< std::thread > threads;
+	for ( int t = 1; t < numThreads; ++t )
+		threads.emplace_back( worker, t );
+	worker( 0 );
+	for ( std::thread& th : threads )
+		th.join();
+	return (int)result.size() == N ? result : std::vector< int >();
+}
 /// Prints provided order of vertices in a readable form.
 void printOrder(const std::vector<int> &order) {
     std::cout << " [";
@@ -237,6 +412,47 @@ int main() {
         order = topologicalSort(g);
         cout << "A topological order of vertices is:";
         printOrder(order);
+    }
+    cout << "\t Testing 'topologicalSort_queue()' on CSR graph ..." << endl; {
+        CsrGraph csr(g);
+        std::vector<int> order = topologicalSort_queue(csr);
+        cout << "A topological order of vertices is:";
+        printOrder(order);
+        cout << "Is valid: " << isTopologicallySorted(g, order) << endl;
+    }
+    cout << "\t Testing 'topologicalSort_parallel()' on CSR graph ..." << endl; {
+        CsrGraph csr(g);
+        std::vector<int> levels;
+        std::vector<int> order = topologicalSort_parallel(csr, levels, 4);
+        cout << "A topological order of vertices is:";
+        printOrder(order);
+        cout << "Is valid: " << isTopologicallySorted(g, order) << endl;
+        cout << "Levels of vertices:";
+        for (int v = 0; v < g.size(); ++v)
+            cout << ' ' << char(v + 'A') << ':' << levels[v];
+        cout << endl;
+    }
+    cout << "\t Testing 'IncrementalTopologicalOrder' ..." << endl; {
+        IncrementalTopologicalOrder inc(g.size());
+        // Add the edges in reverse order of 'g', so vertices are moved
+        for (int u = g.size() - 1; u >= 0; --u)
+            for (int v : g.neighbors(u))
+                inc.addEdge(u, v);
+        cout << "A topological order of vertices is:";
+        printOrder(inc.order());
+        cout << "Is valid: " << isTopologicallySorted(inc.graph(), inc.order()) << endl;
+        cout << "Edge (J,A) is accepted: " << inc.addEdge('J', 'A') << endl;
+        cout << "Edge (H,A) is accepted: " << inc.addEdge('H', 'A') << endl;
+        cout << "Order after adding (H,A):";
+        printOrder(inc.order());
+        cout << "Is valid: " << isTopologicallySorted(inc.graph(), inc.order()) << endl;
+    }
+    cout << "\t Testing 'topologicalSortIncoming()' ..." << endl; {
+        CsrGraph incoming = CsrGraph(g).transposed();
+        std::vector<int> order = topologicalSortIncoming(incoming);
+        cout << "A topological order of vertices is:";
+        printOrder(order);
+        cout << "Is valid: " << isTopologicallySorted(g, order) << endl;
     }
 	{
     	AdjacencyList dag(5);  // 0->1->2, 0->3, 3->4
@@ -261,6 +477,20 @@ int main() {
     	printOrder(ord);
     	cout << "Should be empty: " << (ord.empty() ? "yes" : "no") << endl;
 	}
+    cout << "\t Testing cycle extraction ..." << endl; {
+        AdjacencyList cyclic(g);
+        cyclic.addEdge('J', 'F'); // Closes cycle F->D->J->F, and F->B->J->F
+        std::vector<int> remaining, cycle;
+        std::vector<int> order = topologicalSort_queue(CsrGraph(cyclic), remaining, cycle);
+        cout << "Order is empty: " << order.empty() << endl;
+        cout << "Vertices left with incoming edges:";
+        printOrder(remaining);
+        cout << "A cycle:";
+        printOrder(cycle);
+        topologicalSort(cyclic, remaining, cycle);
+        cout << "A cycle, by 'topologicalSort()':";
+        printOrder(cycle);
+    }
 
 
     return 0;